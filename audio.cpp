@@ -0,0 +1,408 @@
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include "audio.h"
+#include "stretchy_buffer.h"
+
+
+struct IndexedSound {
+    int pcm_offset;             // First sample in pcm_arena
+    int frame_count;
+    float volume;
+    int max_instances;
+    int priority;
+    unsigned int last_play_frame;
+};
+
+struct Voice {
+    int sound_idx;              // -1 when free
+    int cursor;                 // Next frame to mix
+    int priority;
+    unsigned int serial;        // Play order, for picking the oldest voice
+};
+
+enum AudioCommandType {
+    AUDIO_CMD_PLAY,
+    AUDIO_CMD_STOP,
+    AUDIO_CMD_VOLUME,
+    AUDIO_CMD_FRAME,
+};
+
+struct AudioCommand {
+    int type;
+    int sound_idx;
+    float value;
+};
+
+// Single producer (game thread), single consumer (audio thread)
+struct AudioCommandQueue {
+    AudioCommand commands[AUDIO_COMMAND_QUEUE_SIZE];
+    alignas(64) std::atomic<unsigned int> head;     // Written by the game thread
+    alignas(64) std::atomic<unsigned int> tail;     // Written by the audio thread
+};
+
+static IndexedSound* loaded_sounds = nullptr;
+static float* pcm_arena = nullptr;                  // Interleaved device format samples
+static Voice voices[AUDIO_VOICE_COUNT];
+static unsigned int audio_frame = 1;
+static unsigned int play_serial = 0;
+static AudioStats stats = AudioStats();
+static int dropped_commands = 0;
+
+static AudioCommandQueue command_queue;
+static std::thread audio_thread;
+static std::atomic<bool> audio_thread_running(false);
+static bool output_ready = false;
+static int output_sink = AUDIO_SINK_NULL;
+static AudioStream output_stream;
+static FILE* wav_file = nullptr;
+static unsigned int wav_frames_written = 0;
+static float pending_frame_time = 0.f;              // Game time the last frame covers, not mixed yet
+static double offline_frames_due = 0.;              // Fractional sample frames carried between game frames
+static float mix_buffer[AUDIO_MIX_BLOCK_FRAMES * AUDIO_DEVICE_CHANNELS];
+static short wav_buffer[AUDIO_MIX_BLOCK_FRAMES * AUDIO_DEVICE_CHANNELS];
+
+int LoadIndexedSound(const char* filename, const float volume, int max_instances, int priority) {
+    if(max_instances < 1) { max_instances = 1; }
+    if(max_instances > AUDIO_MAX_INSTANCES) { max_instances = AUDIO_MAX_INSTANCES; }
+
+    // Convert once here so mixing is a plain multiply-add per sample
+    std::chrono::steady_clock::time_point convert_start = std::chrono::steady_clock::now();
+    Wave wave = LoadWave(filename);
+    const unsigned int src_rate = wave.sampleRate;
+    const unsigned int src_size = wave.sampleSize;
+    const unsigned int src_channels = wave.channels;
+    if(wave.data != nullptr) {
+        WaveFormat(&wave, AUDIO_DEVICE_SAMPLE_RATE, AUDIO_DEVICE_SAMPLE_SIZE, AUDIO_DEVICE_CHANNELS);
+    }
+
+    IndexedSound snd = IndexedSound();
+    snd.pcm_offset = sb_count(pcm_arena);
+    snd.frame_count = wave.data != nullptr ? (int) (wave.sampleCount / AUDIO_DEVICE_CHANNELS) : 0;
+    snd.volume = volume;
+    snd.max_instances = max_instances;
+    snd.priority = priority;
+    snd.last_play_frame = 0;
+    if(snd.frame_count > 0) {
+        float* dest = sb_add(pcm_arena, snd.frame_count * AUDIO_DEVICE_CHANNELS);
+        memcpy(dest, wave.data, sizeof(float) * snd.frame_count * AUDIO_DEVICE_CHANNELS);
+    }
+    UnloadWave(wave);
+
+    double convert_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - convert_start).count();
+    TraceLog(LOG_INFO, "Sound %s: %u Hz %u-bit %u ch -> %d frames, %d bytes, converted in %.2f ms",
+             filename, src_rate, src_size, src_channels, snd.frame_count,
+             (int) sizeof(float) * snd.frame_count * AUDIO_DEVICE_CHANNELS, convert_ms);
+    sb_push(loaded_sounds, snd);
+    return sb_count(loaded_sounds) - 1;
+}
+
+
+//
+// Audio thread side
+//
+
+static void StartVoice(int sound_idx) {
+    stats.requested++;
+    if(!output_ready) { return; }
+    IndexedSound* snd = &loaded_sounds[sound_idx];
+    if(snd->last_play_frame == audio_frame) {
+        stats.culled_same_frame++;
+        return;
+    }
+
+    int active_same = 0;
+    int oldest_same = -1;
+    int free_idx = -1;
+    for(int i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        Voice* v = &voices[i];
+        if(v->sound_idx < 0) {
+            if(free_idx < 0) { free_idx = i; }
+            continue;
+        }
+        if(v->sound_idx == sound_idx) {
+            active_same++;
+            if(oldest_same < 0 || v->serial < voices[oldest_same].serial) { oldest_same = i; }
+        }
+    }
+
+    int voice_idx = free_idx;
+    bool is_steal = false;
+    if(active_same >= snd->max_instances) {
+        // At the per-sound cap: restart the oldest copy of this sound
+        voice_idx = oldest_same;
+        is_steal = true;
+    } else if(voice_idx < 0) {
+        // Pool is full: take the lowest priority voice, oldest first
+        for(int i = 0; i < AUDIO_VOICE_COUNT; i++) {
+            if(voice_idx < 0 || voices[i].priority < voices[voice_idx].priority ||
+                    (voices[i].priority == voices[voice_idx].priority && voices[i].serial < voices[voice_idx].serial)) {
+                voice_idx = i;
+            }
+        }
+        if(voices[voice_idx].priority > snd->priority) {
+            stats.culled_pool++;
+            return;
+        }
+        is_steal = true;
+    }
+
+    Voice* v = &voices[voice_idx];
+    if(is_steal) { stats.stolen++; }
+    v->sound_idx = sound_idx;
+    v->cursor = 0;
+    v->priority = snd->priority;
+    v->serial = play_serial++;
+    snd->last_play_frame = audio_frame;
+    stats.played++;
+}
+
+static void StopVoices(int sound_idx) {
+    for(int i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        if(voices[i].sound_idx == sound_idx) { voices[i].sound_idx = -1; }
+    }
+}
+
+static void MixOffline(float seconds);
+
+static void DrainCommands() {
+    unsigned int tail = command_queue.tail.load(std::memory_order_relaxed);
+    const unsigned int head = command_queue.head.load(std::memory_order_acquire);
+    while(tail != head) {
+        const AudioCommand cmd = command_queue.commands[tail & (AUDIO_COMMAND_QUEUE_SIZE - 1)];
+        if(cmd.type == AUDIO_CMD_PLAY) {
+            StartVoice(cmd.sound_idx);
+        } else if(cmd.type == AUDIO_CMD_STOP) {
+            StopVoices(cmd.sound_idx);
+        } else if(cmd.type == AUDIO_CMD_VOLUME) {
+            loaded_sounds[cmd.sound_idx].volume = cmd.value;
+        } else if(cmd.type == AUDIO_CMD_FRAME) {
+            // Offline sinks hear the previous frame's sounds for exactly the
+            // game time it lasted, then start this one
+            if(output_sink != AUDIO_SINK_DEVICE) { MixOffline(pending_frame_time); }
+            pending_frame_time = cmd.value;
+            audio_frame++;
+        }
+        tail++;
+    }
+    command_queue.tail.store(tail, std::memory_order_release);
+}
+
+static void MixBlock(float* out, int frame_count) {
+    std::chrono::steady_clock::time_point mix_start = std::chrono::steady_clock::now();
+    memset(out, 0, sizeof(float) * frame_count * AUDIO_DEVICE_CHANNELS);
+    for(int i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        Voice* v = &voices[i];
+        if(v->sound_idx < 0) { continue; }
+        const IndexedSound* snd = &loaded_sounds[v->sound_idx];
+        int frames = snd->frame_count - v->cursor;
+        if(frames > frame_count) { frames = frame_count; }
+        const float* src = pcm_arena + snd->pcm_offset + (v->cursor * AUDIO_DEVICE_CHANNELS);
+        const float volume = snd->volume;
+        for(int s = 0; s < frames * AUDIO_DEVICE_CHANNELS; s++) {
+            out[s] += src[s] * volume;
+        }
+        v->cursor += frames;
+        if(v->cursor >= snd->frame_count) { v->sound_idx = -1; }
+    }
+    stats.mixed_blocks++;
+
+    double block_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mix_start).count();
+    stats.mix_seconds += block_ms / 1000.;
+    if(block_ms > stats.max_block_ms) { stats.max_block_ms = block_ms; }
+}
+
+
+//
+// WAV file sink, 16-bit PCM
+//
+
+static void WriteLE(FILE* file, unsigned int value, int byte_count) {
+    unsigned char bytes[4];
+    for(int i = 0; i < byte_count; i++) {
+        bytes[i] = (unsigned char) ((value >> (8 * i)) & 0xff);
+    }
+    fwrite(bytes, 1, byte_count, file);
+}
+
+static void WriteWavHeader(FILE* file, unsigned int frame_count) {
+    const unsigned int block_align = AUDIO_DEVICE_CHANNELS * sizeof(short);
+    const unsigned int data_bytes = frame_count * block_align;
+    fwrite("RIFF", 1, 4, file);
+    WriteLE(file, 36 + data_bytes, 4);
+    fwrite("WAVEfmt ", 1, 8, file);
+    WriteLE(file, 16, 4);                                           // fmt chunk size
+    WriteLE(file, 1, 2);                                            // PCM
+    WriteLE(file, AUDIO_DEVICE_CHANNELS, 2);
+    WriteLE(file, AUDIO_DEVICE_SAMPLE_RATE, 4);
+    WriteLE(file, AUDIO_DEVICE_SAMPLE_RATE * block_align, 4);      // Bytes per second
+    WriteLE(file, block_align, 2);
+    WriteLE(file, 16, 2);                                           // Bits per sample
+    fwrite("data", 1, 4, file);
+    WriteLE(file, data_bytes, 4);
+}
+
+static void WriteWavBlock(const float* samples, int frame_count) {
+    const int sample_count = frame_count * AUDIO_DEVICE_CHANNELS;
+    for(int i = 0; i < sample_count; i++) {
+        float s = samples[i];
+        if(s > 1.f) { s = 1.f; }
+        if(s < -1.f) { s = -1.f; }
+        wav_buffer[i] = (short) (s * 32767.f);
+    }
+    fwrite(wav_buffer, sizeof(short), sample_count, wav_file);
+    wav_frames_written += frame_count;
+}
+
+// Mixes the given stretch of game time in blocks, for the null and WAV sinks
+static void MixOffline(float seconds) {
+    offline_frames_due += (double) seconds * AUDIO_DEVICE_SAMPLE_RATE;
+    int frame_count = (int) offline_frames_due;
+    offline_frames_due -= frame_count;
+    while(frame_count > 0) {
+        const int block_frames = frame_count < AUDIO_MIX_BLOCK_FRAMES ? frame_count : AUDIO_MIX_BLOCK_FRAMES;
+        MixBlock(mix_buffer, block_frames);
+        if(wav_file != nullptr) { WriteWavBlock(mix_buffer, block_frames); }
+        frame_count -= block_frames;
+    }
+}
+
+static void AudioThreadMain() {
+    // The device sink is paced by the hardware; the others mix as frame
+    // commands arrive
+    while(audio_thread_running.load(std::memory_order_acquire)) {
+        DrainCommands();
+        if(output_sink == AUDIO_SINK_DEVICE && IsAudioStreamProcessed(output_stream)) {
+            MixBlock(mix_buffer, AUDIO_MIX_BLOCK_FRAMES);
+            UpdateAudioStream(output_stream, mix_buffer, AUDIO_MIX_BLOCK_FRAMES * AUDIO_DEVICE_CHANNELS);
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    DrainCommands();
+    // The last frame's sounds still get its share of the output
+    if(output_sink != AUDIO_SINK_DEVICE) { MixOffline(pending_frame_time); }
+    pending_frame_time = 0.f;
+}
+
+void StartAudioThread(int sink, const char* wav_filename) {
+    if(audio_thread_running.load()) { return; }
+    for(int i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        voices[i].sound_idx = -1;
+    }
+
+    if(sink == AUDIO_SINK_DEVICE && !IsAudioDeviceReady()) {
+        TraceLog(LOG_WARNING, "No audio device, mixing to the null sink");
+        sink = AUDIO_SINK_NULL;
+    }
+    if(sink == AUDIO_SINK_WAV) {
+        wav_file = wav_filename != nullptr ? fopen(wav_filename, "wb") : nullptr;
+        if(wav_file == nullptr) {
+            TraceLog(LOG_WARNING, "Could not open %s for audio output, mixing to the null sink",
+                     wav_filename != nullptr ? wav_filename : "(null)");
+            sink = AUDIO_SINK_NULL;
+        } else {
+            wav_frames_written = 0;
+            WriteWavHeader(wav_file, 0);
+        }
+    }
+    if(sink == AUDIO_SINK_DEVICE) {
+        SetAudioStreamBufferSizeDefault(AUDIO_MIX_BLOCK_FRAMES);
+        output_stream = InitAudioStream(AUDIO_DEVICE_SAMPLE_RATE, AUDIO_DEVICE_SAMPLE_SIZE, AUDIO_DEVICE_CHANNELS);
+        PlayAudioStream(output_stream);
+    }
+    output_sink = sink;
+    output_ready = true;
+    pending_frame_time = 0.f;
+    offline_frames_due = 0.;
+    command_queue.head.store(0);
+    command_queue.tail.store(0);
+    audio_thread_running.store(true);
+    audio_thread = std::thread(AudioThreadMain);
+}
+
+void StopAudioThread() {
+    if(!audio_thread_running.load()) { return; }
+    audio_thread_running.store(false, std::memory_order_release);
+    audio_thread.join();
+    if(output_sink == AUDIO_SINK_DEVICE) {
+        StopAudioStream(output_stream);
+        CloseAudioStream(output_stream);
+    }
+    if(wav_file != nullptr) {
+        // Patch the sizes now that the length is known
+        fseek(wav_file, 0, SEEK_SET);
+        WriteWavHeader(wav_file, wav_frames_written);
+        fclose(wav_file);
+        wav_file = nullptr;
+    }
+    output_ready = false;
+}
+
+
+//
+// Game thread side
+//
+
+static void PushCommand(int type, int sound_idx, float value) {
+    const unsigned int head = command_queue.head.load(std::memory_order_relaxed);
+    unsigned int tail = command_queue.tail.load(std::memory_order_acquire);
+    // Offline sinks run on game time, so losing a command would lose sound
+    // or time; wait for the audio thread instead
+    while(head - tail >= (unsigned int) AUDIO_COMMAND_QUEUE_SIZE && output_sink != AUDIO_SINK_DEVICE &&
+          audio_thread_running.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+        tail = command_queue.tail.load(std::memory_order_acquire);
+    }
+    if(head - tail >= (unsigned int) AUDIO_COMMAND_QUEUE_SIZE) {
+        dropped_commands++;
+        return;
+    }
+    AudioCommand* cmd = &command_queue.commands[head & (AUDIO_COMMAND_QUEUE_SIZE - 1)];
+    cmd->type = type;
+    cmd->sound_idx = sound_idx;
+    cmd->value = value;
+    command_queue.head.store(head + 1, std::memory_order_release);
+}
+
+void PlayIndexedSound(int sound_idx) {
+    PushCommand(AUDIO_CMD_PLAY, sound_idx, 0.f);
+}
+
+void StopIndexedSound(int sound_idx) {
+    PushCommand(AUDIO_CMD_STOP, sound_idx, 0.f);
+}
+
+void SetIndexedSoundVolume(int sound_idx, float volume) {
+    PushCommand(AUDIO_CMD_VOLUME, sound_idx, volume);
+}
+
+void AudioBeginFrame(float frame_time) {
+    PushCommand(AUDIO_CMD_FRAME, -1, frame_time);
+}
+
+AudioStats GetAudioStats() {
+    AudioStats result = stats;
+    result.dropped_commands = dropped_commands;
+    result.pcm_bytes = (int) sizeof(float) * sb_count(pcm_arena);
+    return result;
+}
+
+void LogAudioStats() {
+    AudioStats s = GetAudioStats();
+    TraceLog(LOG_INFO, "Audio: %d requested, %d played (%d stolen), %d culled (%d same frame, %d pool full), %d commands dropped",
+             s.requested, s.played, s.stolen,
+             s.culled_same_frame + s.culled_pool, s.culled_same_frame, s.culled_pool, s.dropped_commands);
+    TraceLog(LOG_INFO, "Audio: %d sounds in %d byte PCM arena, %d blocks mixed in %.2f ms (%.3f ms avg, %.3f ms max)",
+             sb_count(loaded_sounds), s.pcm_bytes, s.mixed_blocks, s.mix_seconds * 1000.,
+             s.mixed_blocks > 0 ? s.mix_seconds * 1000. / s.mixed_blocks : 0., s.max_block_ms);
+}
+
+void UnloadIndexedSounds() {
+    sb_free(loaded_sounds);
+    loaded_sounds = nullptr;
+    sb_free(pcm_arena);
+    pcm_arena = nullptr;
+}
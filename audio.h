@@ -0,0 +1,79 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "raylib.h"
+
+
+// Sound effects play through a fixed pool of voices. Each sound has a cap on
+// how many copies may play at once and a priority used to steal voices when
+// the pool is full. Repeat plays of the same sound within one frame are
+// merged into a single voice.
+//
+// Playback is driven from a dedicated audio thread. The game thread only
+// pushes small commands into a lock-free ring. With the device sink,
+// triggering a sound never waits on the audio backend; if the ring is full
+// the command is dropped and counted in dropped_commands. The null and WAV
+// sinks run on game time instead, so when their ring is full the game
+// thread waits for room; they only drop once the audio thread has stopped.
+//
+// At load time every effect is converted to the device format below and kept
+// in one contiguous PCM arena. The audio thread mixes voices straight out of
+// the arena into a single output stream. Load all sounds before starting the
+// audio thread.
+//
+// The mixed output goes to a sink: the raylib audio device, a null sink that
+// only times the mixing work, or a WAV file. The device sink falls back to
+// the null sink when no audio device is available, so the mixing cost is
+// the same on machines without a sound card. The device sink is paced by the
+// hardware. The null and WAV sinks are paced by game time instead: each
+// frame mixes exactly its frame time of output, so a headless run writes a
+// WAV with every sound where the game clock put it, however fast it ran.
+const int AUDIO_VOICE_COUNT = 16;
+const int AUDIO_MAX_INSTANCES = 8;
+const int AUDIO_COMMAND_QUEUE_SIZE = 256;  // Must be a power of two
+
+// Matches the miniaudio device raylib opens: 32-bit float stereo
+const int AUDIO_DEVICE_SAMPLE_RATE = 44100;
+const int AUDIO_DEVICE_SAMPLE_SIZE = 32;
+const int AUDIO_DEVICE_CHANNELS = 2;
+const int AUDIO_MIX_BLOCK_FRAMES = 512;
+
+const int AUDIO_SINK_DEVICE = 0;
+const int AUDIO_SINK_NULL = 1;
+const int AUDIO_SINK_WAV = 2;
+
+const int AUDIO_PRIORITY_LOW = 1;
+const int AUDIO_PRIORITY_NORMAL = 2;
+const int AUDIO_PRIORITY_HIGH = 3;
+
+struct AudioStats {
+    int requested;          // Calls to PlayIndexedSound
+    int played;             // Plays that got a voice (including stolen ones)
+    int stolen;             // Plays that took over a busy voice
+    int culled_same_frame;  // Repeat of a sound already started this frame
+    int culled_pool;        // Pool full of higher priority voices
+    int dropped_commands;   // Ring full on the device sink, or thread stopped
+    int mixed_blocks;       // Blocks of AUDIO_MIX_BLOCK_FRAMES sent to the output
+    int pcm_bytes;          // Size of the PCM arena
+    double mix_seconds;     // Time spent in the mixer
+    double max_block_ms;    // Slowest single block
+};
+
+int LoadIndexedSound(const char* filename, const float volume,
+                     int max_instances = 2, int priority = AUDIO_PRIORITY_NORMAL);
+void StartAudioThread(int sink = AUDIO_SINK_DEVICE, const char* wav_filename = nullptr);
+void StopAudioThread();
+
+// Game thread side, safe to call every frame
+void PlayIndexedSound(int sound_idx);
+void StopIndexedSound(int sound_idx);
+void SetIndexedSoundVolume(int sound_idx, float volume);
+// Marks a new game frame that lasts frame_time seconds
+void AudioBeginFrame(float frame_time);
+
+// Only meaningful once the audio thread has stopped
+AudioStats GetAudioStats();
+void LogAudioStats();
+void UnloadIndexedSounds();
+
+#endif // AUDIO_H
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include "batch.h"
+#include "bot.h"
+#include "stretchy_buffer.h"
+
+
+static const float batch_frame_time = 1.f / 60.f;
+
+struct BatchShared {
+    const BatchConfig* config;
+    const GameAssets* assets;
+    BatchResult* results;
+    std::atomic<int> next_game;
+};
+
+static void PlayBatchGame(const BatchConfig* config, const GameAssets* assets, unsigned int seed, BatchResult* result) {
+    GameConfig game_config = config->game;
+    game_config.seed = seed;
+    game_config.has_view = false;
+    game_config.has_sound = false;
+    Game game;
+    InitGame(&game, assets, &game_config);
+    Bot bot;
+    InitBot(&bot, config->policy, seed, batch_frame_time);
+
+    *result = BatchResult();
+    result->seed = seed;
+    while(result->frames < config->max_frames && game.state < STATE_END_ZOOM) {
+        const FrameInput input = NextBotInput(&bot, &game);
+        auto start = std::chrono::steady_clock::now();
+        UpdateGame(&game, &input);
+        double step_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result->step_seconds += step_ms / 1000.;
+        if(step_ms > result->max_step_ms) { result->max_step_ms = step_ms; }
+
+        result->frames++;
+        result->peak_sprites = std::max(result->peak_sprites, sb_count(game.sprites));
+        result->peak_live_sprites = std::max(result->peak_live_sprites, CountLiveSprites(&game));
+        result->peak_debris = std::max(result->peak_debris, game.debris.count);
+    }
+    result->years = game.earth_revolve_count;
+    result->is_earth_hit = game.state >= STATE_END_ZOOM;
+    result->is_earth_killed_by_flare = game.is_earth_killed_by_flare;
+    result->asteroids_destroyed = game.asteroids_destroyed;
+    result->flares_fired = game.flares_fired;
+    result->shots = bot.stats.shots;
+    result->bot_seconds = bot.stats.think_seconds;
+    result->max_bot_ms = bot.stats.max_think_ms;
+    FreeGame(&game);
+}
+
+static void BatchWorkerMain(BatchShared* shared) {
+    const BatchConfig* config = shared->config;
+    for(;;) {
+        int n = shared->next_game.fetch_add(1, std::memory_order_relaxed);
+        if(n >= config->game_count) { return; }
+        PlayBatchGame(config, shared->assets, config->first_seed + n, &shared->results[n]);
+    }
+}
+
+static bool WriteBatchSummary(const BatchConfig* config, const BatchResult* results, int thread_count, double wall_seconds) {
+    FILE* file = fopen(config->summary_filename, "w");
+    if(file == nullptr) {
+        TraceLog(LOG_WARNING, "Could not open %s for the batch summary", config->summary_filename);
+        return false;
+    }
+    fprintf(file, "seed,policy,frames,years,earth_hit,killed_by_flare,asteroids_destroyed,flares_fired,"
+                  "peak_sprites,peak_live_sprites,peak_debris,step_ms_avg,step_ms_max,bot_ms_avg,bot_ms_max\n");
+    double* years = (double*) malloc(sizeof(double) * config->game_count);
+    double step_seconds = 0.;
+    long long frames = 0;
+    int earth_hits = 0, flare_kills = 0, peak_live_sprites = 0, peak_debris = 0;
+    double max_step_ms = 0.;
+    double bot_seconds = 0., max_bot_ms = 0.;
+    for(int n = 0; n < config->game_count; n++) {
+        const BatchResult* r = &results[n];
+        fprintf(file, "%u,%s,%d,%.3f,%d,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f\n",
+                r->seed, GetBotPolicyName(config->policy), r->frames, r->years,
+                r->is_earth_hit ? 1 : 0, r->is_earth_killed_by_flare ? 1 : 0, r->asteroids_destroyed, r->flares_fired,
+                r->peak_sprites, r->peak_live_sprites, r->peak_debris,
+                r->frames > 0 ? r->step_seconds * 1000. / r->frames : 0., r->max_step_ms,
+                r->frames > 0 ? r->bot_seconds * 1000. / r->frames : 0., r->max_bot_ms);
+        years[n] = r->years;
+        step_seconds += r->step_seconds;
+        frames += r->frames;
+        if(r->is_earth_hit) { earth_hits++; }
+        if(r->is_earth_killed_by_flare) { flare_kills++; }
+        peak_live_sprites = std::max(peak_live_sprites, r->peak_live_sprites);
+        peak_debris = std::max(peak_debris, r->peak_debris);
+        max_step_ms = std::max(max_step_ms, r->max_step_ms);
+        bot_seconds += r->bot_seconds;
+        max_bot_ms = std::max(max_bot_ms, r->max_bot_ms);
+    }
+    std::sort(years, years + config->game_count);
+    double years_sum = 0.;
+    for(int n = 0; n < config->game_count; n++) { years_sum += years[n]; }
+
+    char lines[5][256];
+    snprintf(lines[0], sizeof(lines[0]), "%d games, policy %s, seeds %u to %u, %d threads, %.2f s wall",
+             config->game_count, GetBotPolicyName(config->policy), config->first_seed,
+             config->first_seed + config->game_count - 1, thread_count, wall_seconds);
+    snprintf(lines[1], sizeof(lines[1]), "Years: mean %.2f, min %.2f, median %.2f, max %.2f; %d games lost Earth (%d to a flare)",
+             years_sum / config->game_count, years[0], years[config->game_count / 2], years[config->game_count - 1],
+             earth_hits, flare_kills);
+    snprintf(lines[2], sizeof(lines[2]), "Peaks: %d live sprites, %d debris; steps %.4f ms avg, %.3f ms max",
+             peak_live_sprites, peak_debris, frames > 0 ? step_seconds * 1000. / frames : 0., max_step_ms);
+    snprintf(lines[3], sizeof(lines[3]), "%lld steps, %.0f steps/s, %.2f of %d threads busy",
+             frames, frames / wall_seconds, step_seconds / wall_seconds, thread_count);
+    snprintf(lines[4], sizeof(lines[4]), "Bot: %.4f ms avg, %.3f ms max per frame",
+             frames > 0 ? bot_seconds * 1000. / frames : 0., max_bot_ms);
+    for(int i = 0; i < 5; i++) {
+        fprintf(file, "# %s\n", lines[i]);
+        TraceLog(LOG_INFO, "Batch: %s", lines[i]);
+    }
+    free(years);
+    fclose(file);
+    return true;
+}
+
+bool RunBatch(const BatchConfig* config, const GameAssets* assets) {
+    if(config->game_count < 1) { return false; }
+    int thread_count = config->thread_count;
+    if(thread_count < 1) { thread_count = (int) std::thread::hardware_concurrency(); }
+    if(thread_count < 1) { thread_count = 1; }
+    if(thread_count > config->game_count) { thread_count = config->game_count; }
+
+    BatchShared shared;
+    shared.config = config;
+    shared.assets = assets;
+    shared.results = (BatchResult*) calloc(config->game_count, sizeof(BatchResult));
+    shared.next_game.store(0);
+
+    // Games log every collision; keep that quiet until the totals
+    SetTraceLogLevel(LOG_ERROR);
+    auto start = std::chrono::steady_clock::now();
+    std::thread* workers = new std::thread[thread_count];
+    for(int i = 0; i < thread_count; i++) { workers[i] = std::thread(BatchWorkerMain, &shared); }
+    for(int i = 0; i < thread_count; i++) { workers[i].join(); }
+    delete[] workers;
+    double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    SetTraceLogLevel(LOG_INFO);
+
+    bool is_written = WriteBatchSummary(config, shared.results, thread_count, wall_seconds);
+    free(shared.results);
+    return is_written;
+}
@@ -0,0 +1,46 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "game.h"
+
+
+// Plays many independent games with no window, renderer or audio, for
+// balance work. Each game gets its own seed (first_seed + its number) and a
+// bot of the chosen policy, and runs until Earth is hit or max_frames pass.
+// Games are handed out one at a time to a pool of worker threads, which
+// share nothing but the assets, so throughput grows with the core count.
+//
+// The summary file is CSV with one row per game: survival in years, entity
+// peaks, and the cost of UpdateGame and of the bot. Totals follow as # comment lines and
+// also go to the log, which is held at LOG_ERROR while the games run.
+struct BatchConfig {
+    int game_count;
+    int thread_count;           // 0 for one per core
+    unsigned int first_seed;
+    int policy;                 // BOT_POLICY_*
+    int max_frames;             // Per game, at 60 Hz
+    GameConfig game;            // Template; seed, view and sound are overridden
+    const char* summary_filename;
+};
+
+struct BatchResult {
+    unsigned int seed;
+    int frames;
+    double years;               // earth_revolve_count when the game stopped
+    bool is_earth_hit;
+    bool is_earth_killed_by_flare;
+    int asteroids_destroyed;
+    int flares_fired;
+    int peak_sprites;           // Slots, live or dead
+    int peak_live_sprites;
+    int peak_debris;
+    double step_seconds;        // Total in UpdateGame
+    double max_step_ms;
+    long long shots;            // Flares the bot chose to fire
+    double bot_seconds;         // Total in NextBotInput
+    double max_bot_ms;
+};
+
+bool RunBatch(const BatchConfig* config, const GameAssets* assets);
+
+#endif // BATCH_H
@@ -0,0 +1,227 @@
+#include <chrono>
+#include <math.h>
+#include <string.h>
+#include "bot.h"
+#include "gfx.h"
+#include "orbit.h"
+#include "stretchy_buffer.h"
+#include "vecmath.h"
+
+
+static const char* BOT_POLICY_NAMES[BOT_POLICY_COUNT] = { "idle", "random", "sweep", "autopilot" };
+
+static const float random_fire_rate = 2.f;         // Average shots per second
+static const float sweep_fire_interval = 0.25f;    // Seconds
+static const float sweep_step = 0.4f;              // Radians per shot
+static const float aim_distance = 1000.f;          // Pixels from the Sun
+
+static const float autopilot_horizon = 6.f;        // Seconds ahead
+static const float autopilot_step = 1.f / 60.f;    // Seconds between samples
+static const int AUTOPILOT_SAMPLES = 361;          // horizon / step + 1
+static const int AUTOPILOT_CANDIDATES = 32;        // Stepped through time per frame
+static const float autopilot_margin = 4.f;         // Pixels of slack on every hit test
+static const float autopilot_fire_interval = 0.1f; // Seconds
+static const float autopilot_flare_grace = 0.5f;   // Seconds past the intercept
+
+struct BotThreat {
+    int sprite_idx;
+    float time;                 // Band entry, then impact
+};
+
+void InitBot(Bot* bot, int policy, unsigned int seed, float frame_time) {
+    *bot = Bot();
+    bot->policy = policy;
+    SeedRandomStream(&bot->random, seed, RANDOM_STREAM_BOT);
+    bot->frame_time = frame_time;
+}
+
+// Keeps the count threats with the smallest times, in order
+static void InsertThreat(BotThreat* threats, int* count, int capacity, BotThreat threat) {
+    if(*count == capacity && threat.time >= threats[*count - 1].time) { return; }
+    int i = *count < capacity ? (*count)++ : *count - 1;
+    for(; i > 0 && threats[i - 1].time > threat.time; i--) { threats[i] = threats[i - 1]; }
+    threats[i] = threat;
+}
+
+// Smallest t >= 0 where |offset + velocity t| = speed t, or -1
+static float SolveIntercept(Vector2 offset, Vector2 velocity, float speed) {
+    const float a = Vec2Dot(velocity, velocity) - speed * speed;
+    const float b = 2.f * Vec2Dot(offset, velocity);
+    const float c = Vec2Dot(offset, offset);
+    if(fabsf(a) < 1e-6f) { return b < 0.f ? -c / b : -1.f; }
+    const float disc = b * b - 4.f * a * c;
+    if(disc < 0.f) { return -1.f; }
+    const float root = sqrtf(disc);
+    float t0 = (-b - root) / (2.f * a);
+    float t1 = (-b + root) / (2.f * a);
+    if(t0 > t1) { float t = t0; t0 = t1; t1 = t; }
+    if(t0 >= 0.f) { return t0; }
+    return t1 >= 0.f ? t1 : -1.f;
+}
+
+static bool IsTargeted(Bot* bot, const Game* game, int sprite_idx) {
+    for(int n = 0; n < bot->target_count; n++) {
+        if(bot->targets[n].sprite_idx == sprite_idx && bot->targets[n].serial == game->sprites[sprite_idx].lifetime_serial) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns true when it fires, with bot->aim_angle set
+static bool UpdateAutopilot(Bot* bot, const Game* game) {
+    const double now = game->timeline.sim_time;
+    const Sprite* sprites = game->sprites;
+
+    // Forget asteroids that are gone or whose flare should have landed
+    for(int n = 0; n < bot->target_count; n++) {
+        const BotTarget* target = &bot->targets[n];
+        if(now > target->until || target->sprite_idx >= sb_count(game->sprites) ||
+           sprites[target->sprite_idx].type != TEXTURE_IDX_ASTEROID ||
+           sprites[target->sprite_idx].lifetime_serial != target->serial) {
+            bot->targets[n--] = bot->targets[--bot->target_count];
+        }
+    }
+
+    // Earth over the horizon, one sample per frame; the orbit turns at a
+    // fixed rate, so each sample is the last one turned a step further
+    Vector2 earth_path[AUTOPILOT_SAMPLES];
+    const Vector2 rotor = Vec2FromAngle(-DEG2RAD * ORBIT_EARTH_REVOLVE_DELTA * autopilot_step);
+    Vector2 earth_offset = GetEarthOffset(&game->timeline);
+    for(int k = 0; k < AUTOPILOT_SAMPLES; k++) {
+        earth_path[k] = Vec2Add(game->sun_pos, earth_offset);
+        earth_offset = Vec2RotateBy(earth_offset, rotor);
+    }
+
+    // Asteroids due to enter the band round Earth's orbit soonest
+    const float flare_radius = game->assets->textures[TEXTURE_IDX_FLARE].width / 3.f;
+    BotThreat candidates[AUTOPILOT_CANDIDATES];
+    int candidate_count = 0;
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        const Sprite* roid = &sprites[i];
+        if(roid->type != TEXTURE_IDX_ASTEROID) { continue; }
+        const Vector2 offset = Vec2Sub(Vec2(roid->dest_rect.x, roid->dest_rect.y), game->sun_pos);
+        const float reach = ORBIT_EARTH_REVOLVE_RADIUS + game->earth_radius + roid->dest_rect.width / 3.f + autopilot_margin;
+        const float a = Vec2Dot(roid->velocity, roid->velocity);
+        const float b = 2.f * Vec2Dot(offset, roid->velocity);
+        const float c = Vec2Dot(offset, offset) - reach * reach;
+        if(a <= 0.f || (c > 0.f && b >= 0.f)) { continue; }
+        const float disc = b * b - 4.f * a * c;
+        if(disc < 0.f) { continue; }
+        const float entry = fmaxf((-b - sqrtf(disc)) / (2.f * a), 0.f);
+        if(entry > autopilot_horizon) { continue; }
+        InsertThreat(candidates, &candidate_count, AUTOPILOT_CANDIDATES, { .sprite_idx = i, .time = entry });
+    }
+
+    // Step those through time against Earth, and against the Sun, which
+    // would get them first
+    BotThreat threats[AUTOPILOT_CANDIDATES];
+    int threat_count = 0;
+    for(int n = 0; n < candidate_count; n++) {
+        const Sprite* roid = &sprites[candidates[n].sprite_idx];
+        const Vector2 pos = Vec2(roid->dest_rect.x, roid->dest_rect.y);
+        const float roid_radius = roid->dest_rect.width / 3.f;
+        const float earth_reach = game->earth_radius + roid_radius + autopilot_margin;
+        const float sun_reach = game->sun_radius + roid_radius;
+        for(int k = (int) (candidates[n].time / autopilot_step); k < AUTOPILOT_SAMPLES; k++) {
+            const Vector2 at = Vec2Add(pos, Vec2Scale(roid->velocity, k * autopilot_step));
+            if(Vec2LengthSqr(Vec2Sub(at, game->sun_pos)) <= sun_reach * sun_reach) { break; }
+            if(Vec2LengthSqr(Vec2Sub(at, earth_path[k])) <= earth_reach * earth_reach) {
+                InsertThreat(threats, &threat_count, AUTOPILOT_CANDIDATES, { .sprite_idx = candidates[n].sprite_idx, .time = k * autopilot_step });
+                break;
+            }
+        }
+    }
+    bot->stats.threats += threat_count;
+    if(now < bot->next_fire_time || bot->target_count == BOT_MAX_TARGETS) { return false; }
+
+    // Soonest impact first; hold any shot that would cross Earth on the way
+    const float earth_reach = game->earth_radius + flare_radius + autopilot_margin;
+    const int cross_first = (int) ((ORBIT_EARTH_REVOLVE_RADIUS - earth_reach) / FLARE_SPEED / autopilot_step);
+    const int cross_last = (int) ceilf((ORBIT_EARTH_REVOLVE_RADIUS + earth_reach) / FLARE_SPEED / autopilot_step);
+    for(int n = 0; n < threat_count; n++) {
+        const int i = threats[n].sprite_idx;
+        if(IsTargeted(bot, game, i)) { continue; }
+        const Sprite* roid = &sprites[i];
+        const Vector2 offset = Vec2Sub(Vec2(roid->dest_rect.x, roid->dest_rect.y), game->sun_pos);
+        const float hit_time = SolveIntercept(offset, roid->velocity, FLARE_SPEED);
+        if(hit_time < 0.f || hit_time > threats[n].time) { continue; }
+        const Vector2 dir = Vec2Normalize(Vec2Add(offset, Vec2Scale(roid->velocity, hit_time)));
+
+        bool is_clear = true;
+        for(int k = cross_first; k <= cross_last && k < AUTOPILOT_SAMPLES && is_clear; k++) {
+            const Vector2 flare_pos = Vec2Add(game->sun_pos, Vec2Scale(dir, FLARE_SPEED * k * autopilot_step));
+            is_clear = Vec2LengthSqr(Vec2Sub(flare_pos, earth_path[k])) > earth_reach * earth_reach;
+        }
+        if(!is_clear) {
+            bot->stats.blocked++;
+            continue;
+        }
+
+        bot->aim_angle = atan2f(dir.y, dir.x);
+        bot->targets[bot->target_count++] = { .sprite_idx = i, .serial = roid->lifetime_serial,
+                                              .until = now + hit_time + autopilot_flare_grace };
+        bot->next_fire_time = now + autopilot_fire_interval;
+        bot->stats.shots++;
+        return true;
+    }
+    return false;
+}
+
+FrameInput NextBotInput(Bot* bot, const Game* game) {
+    auto start = std::chrono::steady_clock::now();
+    FrameInput input = FrameInput();
+    input.frame_time = bot->frame_time;
+    input.time = bot->time;
+    bot->time += bot->frame_time;
+
+    if(game->state == STATE_TITLE) {
+        input.mouse_pressed = true;
+    } else if(game->state == STATE_PLAYING) {
+        if(bot->policy == BOT_POLICY_RANDOM) {
+            input.mouse_pressed = RandomFloat(&bot->random) < random_fire_rate * bot->frame_time;
+            if(input.mouse_pressed) { bot->aim_angle = RandomFloatRange(&bot->random, 0.f, 2.f * PI); }
+        } else if(bot->policy == BOT_POLICY_SWEEP && input.time >= bot->next_fire_time) {
+            input.mouse_pressed = true;
+            bot->aim_angle = fmodf(bot->aim_angle + sweep_step, 2.f * PI);
+            bot->next_fire_time = input.time + sweep_fire_interval;
+        } else if(bot->policy == BOT_POLICY_AUTOPILOT) {
+            input.mouse_pressed = UpdateAutopilot(bot, game);
+        }
+    }
+
+    // Flares head from the Sun towards the cursor, so park it along the aim
+    if(input.mouse_pressed) {
+        Vector2 aim = Vec2Add(game->sun_pos, Vec2Scale(Vec2FromAngle(bot->aim_angle), aim_distance));
+        Vector2 screen = GfxWorldToScreen(game->camera, aim);
+        bot->mouse_x = (int) roundf(screen.x);
+        bot->mouse_y = (int) roundf(screen.y);
+    }
+    input.mouse_x = bot->mouse_x;
+    input.mouse_y = bot->mouse_y;
+
+    double think_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    bot->stats.frames++;
+    bot->stats.think_seconds += think_ms / 1000.;
+    if(think_ms > bot->stats.max_think_ms) { bot->stats.max_think_ms = think_ms; }
+    return input;
+}
+
+int FindBotPolicy(const char* name) {
+    for(int i = 0; i < BOT_POLICY_COUNT; i++) {
+        if(strcmp(name, BOT_POLICY_NAMES[i]) == 0) { return i; }
+    }
+    return -1;
+}
+
+const char* GetBotPolicyName(int policy) {
+    return policy >= 0 && policy < BOT_POLICY_COUNT ? BOT_POLICY_NAMES[policy] : "unknown";
+}
+
+void LogBotStats(const Bot* bot) {
+    const BotStats* stats = &bot->stats;
+    TraceLog(LOG_INFO, "Bot %s: %lld frames, %lld shots, %lld impacts foreseen, %lld shots held to spare Earth",
+             GetBotPolicyName(bot->policy), stats->frames, stats->shots, stats->threats, stats->blocked);
+    TraceLog(LOG_INFO, "Bot %s: %.4f ms avg, %.3f ms max per frame", GetBotPolicyName(bot->policy),
+             stats->frames > 0 ? stats->think_seconds * 1000. / stats->frames : 0., stats->max_think_ms);
+}
@@ -0,0 +1,75 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "game.h"
+#include "input.h"
+#include "random.h"
+
+
+// Stand-ins for the player. A bot looks at the game each frame and returns
+// the input a player would have given, on a fixed 60 Hz clock, so games can
+// be played with no one at the mouse. Every policy clicks through the title
+// screen on its first frame; after that:
+//
+//     idle       never fires
+//     random     fires at random times in random directions
+//     sweep      scripted: fires at a fixed rate, turning a fixed step each shot
+//     autopilot  defends Earth: shoots down the asteroids about to hit it
+//
+// The autopilot follows every asteroid in a straight line and Earth round
+// its orbit for a few seconds ahead. A cheap test against the band around
+// Earth's orbit drops most asteroids; only the few due to reach the band
+// soonest are stepped through time to find when they would hit Earth. It
+// then takes the soonest impacts in turn and aims a flare where flare and
+// asteroid meet, unless the flare would cross Earth's path on the way out.
+// Each asteroid it shoots at is left alone until that flare should have
+// arrived. The work per frame is one pass over the sprites plus a fixed
+// amount, however many asteroids there are.
+//
+// Bots only read the game, and draw from their own random stream.
+const int BOT_POLICY_IDLE = 0;
+const int BOT_POLICY_RANDOM = 1;
+const int BOT_POLICY_SWEEP = 2;
+const int BOT_POLICY_AUTOPILOT = 3;
+const int BOT_POLICY_COUNT = 4;
+
+const int BOT_MAX_TARGETS = 64;         // Asteroids with a flare on the way
+
+struct BotTarget {
+    int sprite_idx;
+    unsigned int serial;        // lifetime_serial, in case the slot is reused
+    double until;               // Sim time the flare should have hit by
+};
+
+struct BotStats {
+    long long frames;
+    long long shots;
+    long long threats;          // Impacts foreseen, summed over frames
+    long long blocked;          // Shots held back to spare Earth
+    double think_seconds;
+    double max_think_ms;
+};
+
+struct Bot {
+    int policy;
+    RandomStream random;
+    float frame_time;
+    double time;
+    double next_fire_time;
+    float aim_angle;            // Radians, from the Sun
+    int mouse_x;
+    int mouse_y;
+    BotTarget targets[BOT_MAX_TARGETS];
+    int target_count;
+    BotStats stats;
+};
+
+void InitBot(Bot* bot, int policy, unsigned int seed, float frame_time);
+FrameInput NextBotInput(Bot* bot, const Game* game);
+
+// -1 for an unknown name
+int FindBotPolicy(const char* name);
+const char* GetBotPolicyName(int policy);
+void LogBotStats(const Bot* bot);
+
+#endif // BOT_H
@@ -0,0 +1,77 @@
+#include <math.h>
+#include "cull.h"
+
+
+static Rectangle cull_view = { 0.f, 0.f, 0.f, 0.f };
+static CullStats cull_stats = {};
+
+void SetCullView(Rectangle view) {
+    cull_view = view;
+}
+
+Rectangle GetCullView() {
+    return cull_view;
+}
+
+void BeginCullFrame() {
+    cull_stats.frame_tested = 0;
+    cull_stats.frame_culled = 0;
+}
+
+bool IsQuadVisible(Rectangle dest_rect, Vector2 origin, float rotation) {
+    // Quad corners relative to the pivot at (dest_rect.x, dest_rect.y)
+    const float left = -origin.x;
+    const float top = -origin.y;
+    const float right = dest_rect.width - origin.x;
+    const float bottom = dest_rect.height - origin.y;
+
+    float min_x, max_x, min_y, max_y;
+    if(rotation == 0.f) {
+        min_x = left;
+        max_x = right;
+        min_y = top;
+        max_y = bottom;
+    } else {
+        const float c = cosf(DEG2RAD * rotation);
+        const float s = sinf(DEG2RAD * rotation);
+        const float xs[4] = { left, right, right, left };
+        const float ys[4] = { top, top, bottom, bottom };
+        min_x = max_x = xs[0] * c - ys[0] * s;
+        min_y = max_y = xs[0] * s + ys[0] * c;
+        for(int i = 1; i < 4; i++) {
+            const float x = xs[i] * c - ys[i] * s;
+            const float y = xs[i] * s + ys[i] * c;
+            min_x = fminf(min_x, x);
+            max_x = fmaxf(max_x, x);
+            min_y = fminf(min_y, y);
+            max_y = fmaxf(max_y, y);
+        }
+    }
+
+    const bool is_visible =
+            dest_rect.x + max_x >= cull_view.x &&
+            dest_rect.x + min_x <= cull_view.x + cull_view.width &&
+            dest_rect.y + max_y >= cull_view.y &&
+            dest_rect.y + min_y <= cull_view.y + cull_view.height;
+
+    cull_stats.tested++;
+    cull_stats.frame_tested++;
+    if(!is_visible) {
+        cull_stats.culled++;
+        cull_stats.frame_culled++;
+        if(cull_stats.frame_culled > cull_stats.max_frame_culled) {
+            cull_stats.max_frame_culled = cull_stats.frame_culled;
+        }
+    }
+    return is_visible;
+}
+
+CullStats GetCullStats() {
+    return cull_stats;
+}
+
+void LogCullStats() {
+    TraceLog(LOG_INFO, "Cull: %lld of %lld sprites culled (%.1f%%), at most %d in one frame",
+             cull_stats.culled, cull_stats.tested,
+             cull_stats.tested > 0 ? 100. * cull_stats.culled / cull_stats.tested : 0., cull_stats.max_frame_culled);
+}
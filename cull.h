@@ -0,0 +1,27 @@
+#ifndef CULL_H
+#define CULL_H
+
+#include "raylib.h"
+
+
+// Visibility test run on sprites before they are submitted for drawing.
+// Each quad is bounded by its rotated corners, in the same dest/origin/
+// rotation terms GfxTexturePro takes, and compared against the current view
+// rectangle. Counters track how much drawing the test saved.
+struct CullStats {
+    long long tested;
+    long long culled;
+    int frame_tested;
+    int frame_culled;
+    int max_frame_culled;
+};
+
+void SetCullView(Rectangle view);
+Rectangle GetCullView();
+void BeginCullFrame();
+bool IsQuadVisible(Rectangle dest_rect, Vector2 origin, float rotation);
+
+CullStats GetCullStats();
+void LogCullStats();
+
+#endif // CULL_H
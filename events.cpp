@@ -0,0 +1,41 @@
+#include "events.h"
+#include "sbutil.h"
+#include "stretchy_buffer.h"
+
+
+void PushAsteroidDestroyed(GameEvents* events, AsteroidDestroyedEvent event) {
+    sb_push(events->asteroid_destroyed, event);
+}
+
+void PushEarthHit(GameEvents* events, EarthHitEvent event) {
+    sb_push(events->earth_hit, event);
+}
+
+void PushFlareFired(GameEvents* events, FlareFiredEvent event) {
+    sb_push(events->flare_fired, event);
+}
+
+void PushStateChanged(GameEvents* events, StateChangedEvent event) {
+    sb_push(events->state_changed, event);
+}
+
+int CountGameEvents(const GameEvents* events) {
+    return sb_count(events->asteroid_destroyed) + sb_count(events->earth_hit) +
+           sb_count(events->flare_fired) + sb_count(events->state_changed);
+}
+
+void ClearGameEvents(GameEvents* events) {
+    // Keep the storage; the next step refills it
+    sb_clear(events->asteroid_destroyed);
+    sb_clear(events->earth_hit);
+    sb_clear(events->flare_fired);
+    sb_clear(events->state_changed);
+}
+
+void FreeGameEvents(GameEvents* events) {
+    sb_free(events->asteroid_destroyed);
+    sb_free(events->earth_hit);
+    sb_free(events->flare_fired);
+    sb_free(events->state_changed);
+    *events = GameEvents();
+}
@@ -0,0 +1,57 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "raylib.h"
+
+
+// Gameplay events raised during one simulation step. Each event type has its
+// own array, so the simulation only appends and every consumer (audio,
+// logging, scoring, effects) walks the arrays it cares about in one batch
+// once the step is over. The buffer is cleared after it has been drained.
+const int HIT_BY_SUN = 0;
+const int HIT_BY_FLARE = 1;
+const int HIT_BY_ASTEROID = 2;
+const int HIT_BY_EXPLOSION = 3;
+
+struct AsteroidDestroyedEvent {
+    int sprite_idx;
+    int hit_by;                 // HIT_BY_*
+    int other_idx;              // Sprite that was hit, -1 for the Sun
+    Vector2 pos;
+    Vector2 other_pos;          // The other asteroid is destroyed too
+};
+
+struct EarthHitEvent {
+    int sprite_idx;
+    int hit_by;                 // HIT_BY_ASTEROID or HIT_BY_FLARE
+    Vector2 pos;
+};
+
+struct FlareFiredEvent {
+    int sprite_idx;
+    Vector2 pos;
+    Vector2 direction;
+};
+
+struct StateChangedEvent {
+    int from_state;
+    int to_state;
+};
+
+struct GameEvents {
+    AsteroidDestroyedEvent* asteroid_destroyed;     // stretchy_buffers
+    EarthHitEvent* earth_hit;
+    FlareFiredEvent* flare_fired;
+    StateChangedEvent* state_changed;
+};
+
+void PushAsteroidDestroyed(GameEvents* events, AsteroidDestroyedEvent event);
+void PushEarthHit(GameEvents* events, EarthHitEvent event);
+void PushFlareFired(GameEvents* events, FlareFiredEvent event);
+void PushStateChanged(GameEvents* events, StateChangedEvent event);
+
+int CountGameEvents(const GameEvents* events);
+void ClearGameEvents(GameEvents* events);
+void FreeGameEvents(GameEvents* events);
+
+#endif // EVENTS_H
@@ -0,0 +1,850 @@
+#include <math.h>
+#include "game.h"
+#include "audio.h"
+#include "cull.h"
+#include "gfx.h"
+#include "governor.h"
+#include "sbutil.h"
+#include "stretchy_buffer.h"
+#include "vecmath.h"
+
+
+static const Color COLOR_BACKGROUND = { .r = 0x25, .g = 0x2e, .b = 0x34, .a = 0xff };
+static const Color COLOR_MOUSE_TARGET = { .r = 253, .g = 249, .b = 0, .a = 96 };
+
+static const float COLLISION_CELL_SIZE = 64.f;
+
+static const float title_fade_delta = 128.f;       // Alpha per second
+static const float explosion_lifetime = 1.f;       // Seconds to fade out
+static const double lifetime_tick = 1. / 240.;     // Resolution of the lifetime wheel
+static const Color explosion_tint = { .r=208, .g=255, .b=208, .a=255 };
+static const float debris_drag = 1.5f;             // Fraction of speed lost per second
+static const float debris_size = 2.f;
+static const float shed_star_density = 0.5f;
+static const int shed_debris_divisor = 4;
+static const float distant_sprite_fraction = 0.6f; // Of the view's half height, out from the Sun
+static const float distant_sprite_size = 20.f;     // About the opaque area of a 32 pixel sprite
+// Average opaque colour of each texture, for sprites drawn as flat quads
+static const Color DISTANT_SPRITE_COLORS[TEXTURE_COUNT] = {
+    { 255, 166, 37, 255 }, { 94, 189, 189, 255 }, { 241, 123, 35, 255 },
+    { 94, 122, 125, 255 }, { 117, 119, 120, 255 }, { 232, 111, 27, 255 }
+};
+
+static const float ambient_asteroid_speed = 35.f;
+static const float targeted_asteroid_speed = 100.f;
+static const Color target_asteroid_tint = { 255, 208, 208, 255 };
+// Headings for ambient asteroids, pointing into the field from each side
+static const int AMBIENT_ANGLE_RANGES[4][2] = { { -80, 80 }, { 10, 170 }, { 100, 260 }, { -170, -10 } };
+
+static const float end_zoom_period = 4.f;
+static const float end_zoom_scale_delta = END_ZOOM_SCALE_TARGET / end_zoom_period;
+static const float end_fade_delta = 96.f;          // Alpha per second
+
+static const int SIDE_LEFT = 0;
+static const int SIDE_TOP = 1;
+static const int SIDE_RIGHT = 2;
+
+
+void LoadGameAssets(GameAssets* assets) {
+    TraceLog(LOG_INFO, "Current directory: %s", GetWorkingDirectory());
+    assets->textures[TEXTURE_IDX_SUN] = GfxLoadTexture("assets/sun.png");
+    assets->textures[TEXTURE_IDX_EARTH] = GfxLoadTexture("assets/earthwithclouds.png");
+    assets->textures[TEXTURE_IDX_FLARE] = GfxLoadTexture("assets/flare.png");
+    assets->textures[TEXTURE_IDX_ASTEROID] = GfxLoadTexture("assets/icyasteroid.png");
+    assets->textures[TEXTURE_IDX_SCORCHED] = GfxLoadTexture("assets/scorchedearth.png");
+    assets->textures[TEXTURE_IDX_EXPLOSION] = GfxLoadTexture("assets/explosion.png");
+    TraceLog(LOG_INFO, "Loaded %d textures\n", TEXTURE_COUNT);
+
+    assets->sound_start = LoadIndexedSound("assets/start_1.wav", 1.f, 1, AUDIO_PRIORITY_HIGH);
+    assets->sound_explosions[0] = LoadIndexedSound("assets/explosion_1.wav", 0.8f, 3, AUDIO_PRIORITY_LOW);
+    assets->sound_explosions[1] = LoadIndexedSound("assets/explosion_2.wav", 0.8f, 3, AUDIO_PRIORITY_LOW);
+    assets->sound_explosions[2] = LoadIndexedSound("assets/explosion_3.wav", 0.8f, 3, AUDIO_PRIORITY_LOW);
+    assets->sound_flare = LoadIndexedSound("assets/flare.wav", 0.8f, 4, AUDIO_PRIORITY_NORMAL);
+    assets->sound_scorched_asteroid = LoadIndexedSound("assets/scorched_asteroid.wav", 0.8f, 1, AUDIO_PRIORITY_HIGH);
+    assets->sound_scorched_flare = LoadIndexedSound("assets/scorched_flare.wav", 0.8f, 1, AUDIO_PRIORITY_HIGH);
+    assets->sound_end = LoadIndexedSound("assets/end_3.wav", 1.f, 1, AUDIO_PRIORITY_HIGH);
+}
+
+void UnloadGameAssets(GameAssets* assets) {
+    for(int i = 0; i < TEXTURE_COUNT; i++) {
+        GfxUnloadTexture(assets->textures[i]);
+    }
+}
+
+
+static Sprite CreateSprite(const Game* game, int texture_idx) {
+    Sprite spr = Sprite();
+    spr.texture = game->assets->textures[texture_idx];
+    spr.type = texture_idx;
+    spr.origin = { .x = spr.texture.width / 2.f, .y = spr.texture.height / 2.f };
+    spr.velocity = { .x = 0.f, .y = 0.f };
+    spr.rotation = 0.f;
+    spr.rotation_delta = 0.f;
+    spr.scale = 1.f;
+    spr.src_rect = { .x = 0.f, .y = 0.f, .width = (float) spr.texture.width, .height = (float) spr.texture.height };
+    spr.dest_rect = { .x = 0.f, .y = 0.f, .width = (float) spr.texture.width, .height = (float) spr.texture.height };
+    spr.tint = WHITE;
+    return spr;
+}
+
+// Despawns the sprite once the sim clock reaches expiry_time, unless the
+// sprite dies first or gets a new lifetime
+static void SetSpriteLifetime(Game* game, int idx, double expiry_time) {
+    Sprite* spr = &game->sprites[idx];
+    spr->expiry_time = expiry_time;
+    spr->lifetime_serial = ++game->next_lifetime_serial;
+    if(spr->lifetime_serial == 0) { spr->lifetime_serial = ++game->next_lifetime_serial; }
+    ScheduleTimer(&game->lifetimes, expiry_time, idx, spr->lifetime_serial);
+}
+
+// Projectiles fly straight, so the time they leave the world (by a full
+// sprite size, as the old per-frame bounds test had it) is known up front
+static void SetExitLifetime(Game* game, int idx, double now) {
+    const Sprite* spr = &game->sprites[idx];
+    const float axis_pos[2] = { spr->dest_rect.x, spr->dest_rect.y };
+    const float axis_vel[2] = { spr->velocity.x, spr->velocity.y };
+    const float axis_size[2] = { spr->dest_rect.width, spr->dest_rect.height };
+    const float axis_limit[2] = { (float) game->world_w, (float) game->world_h };
+    double exit_after = -1.;
+    for(int a = 0; a < 2; a++) {
+        if(axis_vel[a] == 0.f) { continue; }
+        const float edge = axis_vel[a] > 0.f ? axis_limit[a] + axis_size[a] : -axis_size[a];
+        const double t = (edge - axis_pos[a]) / axis_vel[a];
+        if(exit_after < 0. || t < exit_after) { exit_after = t; }
+    }
+    if(exit_after < 0.) { return; }     // Not moving; lives until something hits it
+    SetSpriteLifetime(game, idx, now + exit_after);
+}
+
+static int AddSprite(Game* game, Sprite sprite) {
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        if(game->sprites[i].type < 0) {
+            game->sprites[i] = sprite;
+            return i;
+        }
+    }
+    sb_push(game->sprites, sprite);
+    return sb_count(game->sprites) - 1;
+}
+
+// Finds count slots for new sprites, reusing dead ones first, in one pass
+static void ReserveSprites(Game* game, int count, int* out_idxs) {
+    int found = 0;
+    for(int i = 0; i < sb_count(game->sprites) && found < count; i++) {
+        if(game->sprites[i].type < 0) { out_idxs[found++] = i; }
+    }
+    if(found < count) {
+        int first_new = sb_count(game->sprites);
+        sb_add(game->sprites, count - found);
+        for(int i = first_new; found < count; i++) { out_idxs[found++] = i; }
+    }
+}
+
+static int ExplodeSprite(Game* game, int old_idx) {
+    int new_idx = AddSprite(game, CreateSprite(game, TEXTURE_IDX_EXPLOSION));
+    // Taken after the add, which may have moved the buffer
+    Sprite* sprites = game->sprites;
+    sprites[new_idx].dest_rect.x = sprites[old_idx].dest_rect.x;
+    sprites[new_idx].dest_rect.y = sprites[old_idx].dest_rect.y;
+    sprites[new_idx].rotation = (float) RandomInt(&game->effects_random, 0, 360);
+    sprites[new_idx].rotation_delta = 90.f;
+    sprites[new_idx].tint = explosion_tint;
+    sprites[old_idx].type *= -1;
+    SetSpriteLifetime(game, new_idx, game->timeline.sim_time + explosion_lifetime);
+    // Later collision checks this frame can hit the new explosion
+    InsertSpatialGrid(&game->collision_grid, new_idx, sprites[new_idx].dest_rect.x, sprites[new_idx].dest_rect.y,
+                      fmin(sprites[new_idx].dest_rect.width, sprites[new_idx].dest_rect.height) / 3.f);
+    return new_idx;
+}
+
+
+static Vector2 RandomEdgePoint(Game* game, int side) {
+    RandomStream* rng = &game->spawn_random;
+    if(side == SIDE_LEFT) { return { .x = 0.f, .y = (float) RandomInt(rng, 0, game->world_h) }; }
+    if(side == SIDE_TOP) { return { .x = (float) RandomInt(rng, 0, game->world_w), .y = 0.f }; }
+    if(side == SIDE_RIGHT) { return { .x = (float) game->world_w, .y = (float) RandomInt(rng, 0, game->world_h) }; }
+    return { .x = (float) RandomInt(rng, 0, game->world_w), .y = (float) game->world_h };
+}
+
+int CountLiveSprites(const Game* game) {
+    int live_sprites = 0;
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        if(game->sprites[i].type >= 0) { live_sprites++; }
+    }
+    return live_sprites;
+}
+
+
+static Vector2 GetAimDirection(const Game* game, int mouse_x, int mouse_y) {
+    Vector2 mouse_world = GfxScreenToWorld(game->camera, Vec2((float) mouse_x, (float) mouse_y));
+    return Vec2Direction(game->sun_pos, mouse_world);
+}
+
+// Shared by the title and playing states: aiming, flares, stars, orbit
+static void UpdateSolarSystem(Game* game, const FrameInput* input) {
+    // Update mouse targeting; do this before handling mouse input
+    if(!game->mouse_has_moved && (input->mouse_x != game->mouse_init_x || input->mouse_y != game->mouse_init_y)) {
+        game->mouse_has_moved = true;
+    }
+    Vector2 mouse_dir = GetAimDirection(game, input->mouse_x, input->mouse_y);
+    game->mouse_target_x = (game->world_diam * mouse_dir.x) + game->sun_sprite.dest_rect.x;
+    game->mouse_target_y = (game->world_diam * mouse_dir.y) + game->sun_sprite.dest_rect.y;
+
+    // Handle mouse clicks
+    if(input->mouse_pressed) {
+        int idx = AddSprite(game, CreateSprite(game, TEXTURE_IDX_FLARE));
+        Sprite* flare = &game->sprites[idx];
+        flare->dest_rect.x = game->sun_sprite.dest_rect.x;
+        flare->dest_rect.y = game->sun_sprite.dest_rect.y;
+        flare->velocity = Vec2Scale(mouse_dir, FLARE_SPEED);
+        // The click came click_lead seconds before this step; start the
+        // flare as far out as it would have flown since
+        flare->dest_rect.x += flare->velocity.x * input->click_lead;
+        flare->dest_rect.y += flare->velocity.y * input->click_lead;
+        flare->rotation = Vec2AngleDegrees(mouse_dir) + 90.f;
+        // TraceLog(LOG_INFO, " -- added flare idx=%d, pos=(%d, %d), vel=[%.2f,%.2f], rotation=%d",
+        //          idx, (int) flare->dest_rect.x, (int) flare->dest_rect.y,
+        //          flare->velocity.x, flare->velocity.y, (int) flare->rotation);
+        SetExitLifetime(game, idx, game->timeline.sim_time);
+        PushFlareFired(&game->events, { .sprite_idx = idx, .pos = game->sun_pos, .direction = mouse_dir });
+    }
+
+    // Update the stars
+    UpdateStarField(&game->star_field);
+
+    // Update Earth revolution
+    AdvanceTimeline(&game->timeline, input->frame_time);
+    Vector2 earth_offset = GetEarthOffset(&game->timeline);
+    game->earth_sprite.dest_rect.x = earth_offset.x + game->sun_sprite.dest_rect.x;
+    game->earth_sprite.dest_rect.y = earth_offset.y + game->sun_sprite.dest_rect.y;
+    game->earth_pos.x = game->earth_sprite.dest_rect.x;
+    game->earth_pos.y = game->earth_sprite.dest_rect.y;
+    game->earth_radius = game->earth_sprite.dest_rect.width / 4.f;
+
+    // Update Sun rotation
+    game->sun_sprite.rotation = GetSunRotation(&game->timeline);
+}
+
+static void UpdateSprites(Game* game, float frame_time) {
+    Sprite* sprites = game->sprites;
+    for(int i = 0; i < sb_count(sprites); i++) {
+        if(sprites[i].type < 0) { continue; }
+        sprites[i].dest_rect.x += sprites[i].velocity.x * frame_time;
+        sprites[i].dest_rect.y += sprites[i].velocity.y * frame_time;
+
+        sprites[i].rotation += sprites[i].rotation_delta * frame_time;
+        if(sprites[i].rotation < 0.f) { sprites[i].rotation += 360.f; }
+        if(sprites[i].rotation > 360.f) { sprites[i].rotation -= 360.f; }
+
+        // Fade out explosions over their lifetime
+        if(sprites[i].type == TEXTURE_IDX_EXPLOSION) {
+            float exp_alpha = 255.f * (float) (sprites[i].expiry_time - game->timeline.sim_time) / explosion_lifetime;
+            sprites[i].tint.a = exp_alpha <= 0.f ? 0 : (unsigned char) roundf(exp_alpha);
+        }
+    }
+
+    // Despawn faded explosions and sprites that left the world
+    const TimerEntry* expired;
+    int expired_count = AdvanceTimerWheel(&game->lifetimes, game->timeline.sim_time, &expired);
+    for(int n = 0; n < expired_count; n++) {
+        Sprite* spr = &sprites[expired[n].id];
+        if(spr->type < 0 || spr->lifetime_serial != expired[n].serial) { continue; }
+        // TraceLog(LOG_INFO, " -- removing sprite at idx=%d (type=%d)", expired[n].id, spr->type);
+        spr->type *= -1;
+    }
+    UpdateParticles(&game->debris, frame_time);
+}
+
+static void UpdateSpawns(Game* game) {
+    SpawnEvent spawn_event;
+    while(PopDueSpawn(&game->spawner, game->timeline.sim_time, &spawn_event)) {
+        const SpawnRule* rule = &game->spawner.rules[spawn_event.rule_idx];
+        int spawn_idxs[SPAWN_MAX_BATCH];
+        ReserveSprites(game, rule->count, spawn_idxs);
+        for(int n = 0; n < rule->count; n++) {
+            Sprite* roid = &game->sprites[spawn_idxs[n]];
+            *roid = CreateSprite(game, TEXTURE_IDX_ASTEROID);
+            int side = RandomInt(&game->spawn_random, 0, 3);
+            Vector2 start = RandomEdgePoint(game, side);
+            roid->dest_rect.x = start.x;
+            roid->dest_rect.y = start.y;
+            if(rule->kind == SPAWN_KIND_TARGETED) {
+                Vector2 dir_to_earth = Vec2Direction(start, Vec2(game->earth_sprite.dest_rect.x, game->earth_sprite.dest_rect.y));
+                roid->velocity = Vec2Scale(dir_to_earth, targeted_asteroid_speed);
+                roid->tint = target_asteroid_tint;
+            } else {
+                float angle = (float) RandomInt(&game->spawn_random, AMBIENT_ANGLE_RANGES[side][0], AMBIENT_ANGLE_RANGES[side][1]);
+                roid->velocity = Vec2Scale(Vec2FromAngle(DEG2RAD * angle), ambient_asteroid_speed);
+            }
+            roid->rotation = (float) RandomInt(&game->spawn_random, 0, 360);
+            roid->rotation_delta = (float) RandomInt(&game->spawn_random, 30, 50);
+            SetExitLifetime(game, spawn_idxs[n], game->timeline.sim_time);
+            // TraceLog(LOG_INFO, " -- added asteroid idx=%d, kind=%d, side=%d, pos=(%d, %d), vel=[%.2f, %.2f], rotation=%d",
+            //          spawn_idxs[n], rule->kind, side, (int) roid->dest_rect.x, (int) roid->dest_rect.y,
+            //          roid->velocity.x, roid->velocity.y, (int) roid->rotation);
+        }
+        ScheduleNextSpawn(&game->spawner, spawn_event.rule_idx, game->timeline.sim_time, game->earth_revolve_count);
+    }
+}
+
+// Returns true when Earth was hit
+static bool UpdateCollisions(Game* game) {
+    bool earth_dead = false;
+
+    // Bucket live sprites so each asteroid only tests its neighbours
+    ClearSpatialGrid(&game->collision_grid);
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        const Sprite* spr = &game->sprites[i];
+        if(spr->type < 0) { continue; }
+        InsertSpatialGrid(&game->collision_grid, i, spr->dest_rect.x, spr->dest_rect.y,
+                          fmin(spr->dest_rect.width, spr->dest_rect.height) / 3.f);
+    }
+
+    // Check asteroid collisions. Exploding adds sprites, which can move the
+    // array, so sprites are always reached through game->sprites here.
+    Vector2 roid_pos, other_pos;
+    float roid_radius, other_radius;
+    const int* candidates;
+    int candidate_count, hit_idx;
+    for(int i = 0; i < sb_count(game->sprites) && !earth_dead; i++) {
+        if(game->sprites[i].type != TEXTURE_IDX_ASTEROID) { continue; }
+        roid_pos.x = game->sprites[i].dest_rect.x;
+        roid_pos.y = game->sprites[i].dest_rect.y;
+        roid_radius = game->sprites[i].dest_rect.width / 3.f;
+
+        // Check collision with Sun -- explode current asteroid
+        if(CheckCollisionCircles(roid_pos, roid_radius, game->sun_pos, game->sun_radius)) {
+            ExplodeSprite(game, i);
+            PushAsteroidDestroyed(&game->events, { .sprite_idx = i, .hit_by = HIT_BY_SUN, .other_idx = -1,
+                                                   .pos = roid_pos, .other_pos = game->sun_pos });
+            goto next_roid;
+        }
+
+        // Check collision with Earth -- explode asteroid, scorch Earth
+        if(CheckCollisionCircles(roid_pos, roid_radius, game->earth_pos, game->earth_radius)) {
+            ExplodeSprite(game, i);
+            PushEarthHit(&game->events, { .sprite_idx = i, .hit_by = HIT_BY_ASTEROID, .pos = roid_pos });
+            earth_dead = true;
+            goto next_roid;
+        }
+
+        // Check collision with other asteroids & flares -- explode them on contact.
+        // The lowest colliding index wins, as with a plain scan over all sprites.
+        candidates = QuerySpatialGrid(&game->collision_grid, roid_pos.x, roid_pos.y,
+                                      roid_radius + game->collision_grid.max_radius, &candidate_count);
+        hit_idx = -1;
+        for(int c = 0; c < candidate_count; c++) {
+            int j = candidates[c];
+            if(i == j) { continue; }
+            if(game->sprites[j].type < 0) { continue; }
+            if(hit_idx >= 0 && j >= hit_idx) { continue; }
+            other_pos.x = game->sprites[j].dest_rect.x;
+            other_pos.y = game->sprites[j].dest_rect.y;
+            other_radius = fmin(game->sprites[j].dest_rect.width, game->sprites[j].dest_rect.height) / 3.f;
+            if(CheckCollisionCircles(roid_pos, roid_radius, other_pos, other_radius)) { hit_idx = j; }
+        }
+        if(hit_idx >= 0) {
+            int j = hit_idx;
+            const int other_type = game->sprites[j].type;
+            other_pos.x = game->sprites[j].dest_rect.x;
+            other_pos.y = game->sprites[j].dest_rect.y;
+            PushAsteroidDestroyed(&game->events, {
+                .sprite_idx = i,
+                .hit_by = other_type == TEXTURE_IDX_FLARE ? HIT_BY_FLARE :
+                              other_type == TEXTURE_IDX_EXPLOSION ? HIT_BY_EXPLOSION : HIT_BY_ASTEROID,
+                .other_idx = j, .pos = roid_pos, .other_pos = other_pos });
+
+            // Explode primary asteroid
+            ExplodeSprite(game, i);
+
+            // If other is also asteroid, explode it too
+            if(other_type == TEXTURE_IDX_ASTEROID) {
+                ExplodeSprite(game, j);
+            }
+            goto next_roid;
+        }
+        next_roid:;
+    }
+
+    // Check flare collisions with Earth
+    for(int i = 0; i < sb_count(game->sprites) && !earth_dead; i++) {
+        if(game->sprites[i].type != TEXTURE_IDX_FLARE) { continue; }
+        // Just call it a 'roid for now
+        roid_pos.x = game->sprites[i].dest_rect.x;
+        roid_pos.y = game->sprites[i].dest_rect.y;
+        roid_radius = game->sprites[i].dest_rect.width / 3.f;
+
+        // Check collision with Earth -- remove flare, scorch Earth
+        if(CheckCollisionCircles(roid_pos, roid_radius, game->earth_pos, game->earth_radius)) {
+            ExplodeSprite(game, i);
+            PushEarthHit(&game->events, { .sprite_idx = i, .hit_by = HIT_BY_FLARE, .pos = roid_pos });
+            earth_dead = true;
+        }
+    }
+    return earth_dead;
+}
+
+
+static void DrawEarthAndSun(const Game* game) {
+    const Sprite* sun = &game->sun_sprite;
+    const Sprite* earth = &game->earth_sprite;
+    GfxBeginCamera(game->camera);
+    // Draw target line under Sun
+    if(game->mouse_has_moved && game->has_latched_aim) {
+        GfxLine(sun->dest_rect.x, sun->dest_rect.y, game->latched_target_x, game->latched_target_y, COLOR_MOUSE_TARGET);
+    } else if(game->mouse_has_moved) {
+        GfxLine(sun->dest_rect.x, sun->dest_rect.y, game->mouse_target_x, game->mouse_target_y, COLOR_MOUSE_TARGET);
+    }
+    GfxTexturePro(sun->texture, sun->src_rect, sun->dest_rect, sun->origin, sun->rotation, WHITE);
+    GfxTexturePro(earth->texture, earth->src_rect, earth->dest_rect, earth->origin, earth->rotation, WHITE);
+    GfxEndCamera();
+}
+
+static Color TintColor(Color color, Color tint) {
+    return { .r = (unsigned char) (color.r * tint.r / 255), .g = (unsigned char) (color.g * tint.g / 255),
+             .b = (unsigned char) (color.b * tint.b / 255), .a = (unsigned char) (color.a * tint.a / 255) };
+}
+
+static void DrawSprites(Game* game) {
+    const Sprite* sprites = game->sprites;
+    // Under load, sprites out towards the edges are drawn as one batch of
+    // flat quads instead of rotated textures
+    const bool is_simple = game->quality_level >= QUALITY_SIMPLE_SPRITES;
+    const float near_radius = (game->screen_h / 2.f) / game->camera.zoom * distant_sprite_fraction;
+    sb_clear(game->distant_xs);
+    sb_clear(game->distant_ys);
+    sb_clear(game->distant_colors);
+    GfxBeginCamera(game->camera);
+    BeginCullFrame();
+    for(int i = 0; i < sb_count(sprites); i++) {
+        if(sprites[i].type < 0) { continue; }
+        if(!IsQuadVisible(sprites[i].dest_rect, sprites[i].origin, sprites[i].rotation)) { continue; }
+        if(is_simple) {
+            const float dx = sprites[i].dest_rect.x - game->sun_pos.x;
+            const float dy = sprites[i].dest_rect.y - game->sun_pos.y;
+            if(dx * dx + dy * dy > near_radius * near_radius) {
+                sb_push(game->distant_xs, sprites[i].dest_rect.x);
+                sb_push(game->distant_ys, sprites[i].dest_rect.y);
+                sb_push(game->distant_colors, TintColor(DISTANT_SPRITE_COLORS[sprites[i].type], sprites[i].tint));
+                continue;
+            }
+        }
+        GfxTexturePro(sprites[i].texture, sprites[i].src_rect, sprites[i].dest_rect,
+                       sprites[i].origin, sprites[i].rotation, sprites[i].tint);
+    }
+    if(sb_count(game->distant_xs) > 0) {
+        GfxQuadBatch(game->distant_xs, game->distant_ys, game->distant_colors, sb_count(game->distant_xs), distant_sprite_size);
+    }
+    DrawParticles(&game->debris, debris_size);
+    GfxEndCamera();
+}
+
+static void DrawScorchedEarth(Game* game) {
+    const Sprite* earth = &game->earth_sprite;
+    Vector2 earth_corner = { .x = earth->dest_rect.x - (earth->dest_rect.width / 2.f),
+                             .y = earth->dest_rect.y - (earth->dest_rect.height / 2.f) };
+    GfxBeginCamera(game->camera);
+    GfxTextureEx(earth->texture, earth_corner, earth->rotation, earth->scale, earth->tint);
+    GfxEndCamera();
+}
+
+static void DrawTitleScreen(Game* game) {
+    const TextLayerLine title_lines[] = {
+        { "SOLAR", 14, 14, 80, RED },
+        { "SOLAR", 10, 10, 80, WHITE },
+        { "COMMANDER", 14, 104, 80, RED },
+        { "COMMANDER", 10, 100, 80, WHITE },
+        { "Keep Earth Alive  < Ludum Dare 46 >", 10, 190, 20, YELLOW },
+        { "Protect Earth from asteroids", 10, game->screen_h - 80, 20, YELLOW },
+        { "Use mouse to shoot solar flares", 10, game->screen_h - 50, 20, YELLOW }
+    };
+    DrawStarField(&game->star_field, WHITE, game->quality_level >= QUALITY_FEWER_STARS ? shed_star_density : 1.f);
+    DrawEarthAndSun(game);
+    unsigned char title_alpha = (unsigned char) game->title_fade_alpha;
+    DrawTextLayer(&game->title_layer, title_lines, sizeof(title_lines) / sizeof(title_lines[0]), title_alpha);
+    DrawSprites(game);
+}
+
+static void DrawEndText(Game* game) {
+    unsigned char end_alpha = (unsigned char) game->end_fade_alpha;
+    const TextLayerLine end_lines[] = {
+        { "SCORCHED", 14, 14, 80, RED },
+        { "SCORCHED", 10, 10, 80, WHITE },
+        { "EARTH", 14, 104, 80, RED },
+        { "EARTH", 10, 100, 80, WHITE },
+        { CachedTextFormat(&game->end_years_text, game->end_message, game->earth_revolve_count, 0.1), 10, 190, 20, YELLOW },
+        { CachedTextFormat(&game->record_years_text, "Record: %.1f years", game->max_earth_revolve_count, 0.1), 10, 220, 20, YELLOW }
+    };
+    DrawTextLayer(&game->end_layer, end_lines, sizeof(end_lines) / sizeof(end_lines[0]), end_alpha);
+}
+
+
+// State handlers, in table order
+
+static void UpdateTitle(Game* game, const FrameInput* input) {
+    UpdateSolarSystem(game, input);
+    if(input->mouse_pressed) { ChangeGameState(game, STATE_TITLE_FADE); }
+    UpdateSprites(game, input->frame_time);
+}
+
+static void EnterTitleFade(Game* game) {
+    game->title_fade_alpha = 255.f;
+}
+
+static void UpdateTitleFade(Game* game, const FrameInput* input) {
+    UpdateSolarSystem(game, input);
+    game->title_fade_alpha -= title_fade_delta * input->frame_time;
+    if(game->title_fade_alpha <= 0.f) { ChangeGameState(game, STATE_PLAYING); }
+    UpdateSprites(game, input->frame_time);
+}
+
+static void EnterPlaying(Game* game) {
+    StartPlayClock(&game->timeline);
+    ResetSpawnScheduler(&game->spawner, game->timeline.sim_time);
+}
+
+static void UpdatePlaying(Game* game, const FrameInput* input) {
+    UpdateSolarSystem(game, input);
+    game->earth_revolve_count = GetYearCount(&game->timeline);
+    if(game->earth_revolve_count > game->max_earth_revolve_count) {
+        game->max_earth_revolve_count = game->earth_revolve_count;
+    }
+    UpdateSpawns(game);
+    UpdateSprites(game, input->frame_time);
+    if(UpdateCollisions(game)) { ChangeGameState(game, STATE_END_ZOOM); }
+}
+
+static void DrawPlaying(Game* game) {
+    DrawStarField(&game->star_field, WHITE, game->quality_level >= QUALITY_FEWER_STARS ? shed_star_density : 1.f);
+    DrawEarthAndSun(game);
+    DrawSprites(game);
+    GfxText(CachedTextFormat(&game->hud_years_text, "Earth alive: %0.2f years", game->earth_revolve_count, 0.01), 10, 10, 20, YELLOW);
+}
+
+static void EnterEndZoom(Game* game) {
+    Sprite* earth = &game->earth_sprite;
+    earth->texture = game->assets->textures[TEXTURE_IDX_SCORCHED];
+
+    // Calculate earth velocity
+    game->end_zoom_earth_target_x = game->camera.target.x;
+    game->end_zoom_earth_target_y = game->camera.target.y;
+    earth->dest_rect.x -= earth->dest_rect.width / 2.f;
+    earth->dest_rect.y -= earth->dest_rect.height / 2.f;
+    earth->velocity.x = (game->end_zoom_earth_target_x - earth->dest_rect.x) / end_zoom_period;
+    earth->velocity.y = (game->end_zoom_earth_target_y - earth->dest_rect.y) / end_zoom_period;
+}
+
+static void UpdateEndZoom(Game* game, const FrameInput* input) {
+    Sprite* earth = &game->earth_sprite;
+    earth->dest_rect.x += earth->velocity.x * input->frame_time;
+    earth->dest_rect.y += earth->velocity.y * input->frame_time;
+    // TraceLog(LOG_INFO, " -- earth_pos updated to (%.2f, %.2f)", earth->dest_rect.x, earth->dest_rect.y);
+    earth->scale += end_zoom_scale_delta * input->frame_time;
+    if(earth->scale >= END_ZOOM_SCALE_TARGET) { ChangeGameState(game, STATE_END_FADE); }
+}
+
+static void ExitEndZoom(Game* game) {
+    Sprite* earth = &game->earth_sprite;
+    earth->velocity = { 0.f, 0.f };
+    earth->scale = END_ZOOM_SCALE_TARGET;
+    earth->dest_rect.x = game->end_zoom_earth_target_x;
+    earth->dest_rect.y = game->end_zoom_earth_target_y;
+}
+
+static void EnterEndFade(Game* game) {
+    game->end_fade_alpha = 0.f;
+}
+
+static void UpdateEndFade(Game* game, const FrameInput* input) {
+    game->end_fade_alpha += end_fade_delta * input->frame_time;
+    if(game->end_fade_alpha >= 255.f) { ChangeGameState(game, STATE_END_CHOICE); }
+}
+
+static void DrawEndFade(Game* game) {
+    DrawScorchedEarth(game);
+    DrawEndText(game);
+}
+
+static void EnterEndChoice(Game* game) {
+    game->end_fade_alpha = 255.f;
+}
+
+static void UpdateEndChoice(Game* game, const FrameInput* input) {
+    if(input->mouse_pressed) { ChangeGameState(game, STATE_PLAYING); }
+}
+
+static void DrawEndChoice(Game* game) {
+    const TextLayerLine end_choice_lines[] = {
+        { "Click to play again", 10, game->screen_h / 2, 20, YELLOW },
+        { "Code: Steve Blackwell", 10, game->screen_h - 80, 20, YELLOW },
+        { "Art & sound: Connie Ma", 10, game->screen_h - 50, 20, YELLOW }
+    };
+    DrawEndFade(game);
+    unsigned char end_alpha = (unsigned char) game->end_fade_alpha;
+    DrawTextLayer(&game->end_choice_layer, end_choice_lines, sizeof(end_choice_lines) / sizeof(end_choice_lines[0]), end_alpha);
+}
+
+static void ExitEndChoice(Game* game) {
+    // Clear the field for the next game
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        if(game->sprites[i].type > 0) {
+            game->sprites[i].type *= -1;
+        }
+    }
+    ClearParticles(&game->debris);
+    ClearTimerWheel(&game->lifetimes, game->timeline.sim_time);
+    game->earth_revolve_count = 0.;
+    RestartOrbit(&game->timeline);
+    game->earth_sprite.scale = 1.f;
+    game->earth_sprite.texture = game->assets->textures[TEXTURE_IDX_EARTH];
+    game->earth_sprite.velocity = { 0, 0 };
+}
+
+struct GameStateHandlers {
+    const char* name;
+    void (*enter)(Game* game);
+    void (*update)(Game* game, const FrameInput* input);
+    void (*draw)(Game* game);
+    void (*exit)(Game* game);
+};
+
+static const GameStateHandlers STATE_HANDLERS[STATE_COUNT] = {
+    { "title", nullptr, UpdateTitle, DrawTitleScreen, nullptr },
+    { "title fade", EnterTitleFade, UpdateTitleFade, DrawTitleScreen, nullptr },
+    { "playing", EnterPlaying, UpdatePlaying, DrawPlaying, nullptr },
+    { "end zoom", EnterEndZoom, UpdateEndZoom, DrawScorchedEarth, ExitEndZoom },
+    { "end fade", EnterEndFade, UpdateEndFade, DrawEndFade, nullptr },
+    { "end choice", EnterEndChoice, UpdateEndChoice, DrawEndChoice, ExitEndChoice }
+};
+
+
+// Event consumers, run in batch once the step is over
+
+static void LogGameEvents(const Game* game) {
+    static const char* HIT_NAMES[] = { "sun", "flare", "other asteroid", "explosion" };
+    const GameEvents* events = &game->events;
+    const bool is_quiet = game->quality_level >= QUALITY_QUIET_LOG;
+    for(int n = 0; n < sb_count(events->asteroid_destroyed) && !is_quiet; n++) {
+        const AsteroidDestroyedEvent* ev = &events->asteroid_destroyed[n];
+        if(ev->hit_by == HIT_BY_SUN) {
+            TraceLog(LOG_INFO, "Collision: asteroid (idx=%d) & sun", ev->sprite_idx);
+        } else {
+            TraceLog(LOG_INFO, "Collision: asteroid (idx=%d) & %s (idx=%d)", ev->sprite_idx, HIT_NAMES[ev->hit_by], ev->other_idx);
+        }
+    }
+    for(int n = 0; n < sb_count(events->earth_hit) && !is_quiet; n++) {
+        const EarthHitEvent* ev = &events->earth_hit[n];
+        TraceLog(LOG_INFO, "Collision: %s (idx=%d) & EARTH!!", ev->hit_by == HIT_BY_FLARE ? "flare" : "asteroid", ev->sprite_idx);
+    }
+    for(int n = 0; n < sb_count(events->state_changed); n++) {
+        const StateChangedEvent* ev = &events->state_changed[n];
+        if(ev->to_state == STATE_END_ZOOM) {
+            const Sprite* earth = &game->earth_sprite;
+            TraceLog(LOG_INFO, "Starting transition to end zoom");
+            TraceLog(LOG_INFO, "Earth move starting at (%d, %d), moving toward (%d, %d), so delta=[%d, %d], and velocity=[%.2f, %.2f]",
+                     (int) earth->dest_rect.x, (int) earth->dest_rect.y,
+                     (int) game->end_zoom_earth_target_x, (int) game->end_zoom_earth_target_y,
+                     (int) earth->dest_rect.x - (int) game->end_zoom_earth_target_x, (int) earth->dest_rect.y - (int) game->end_zoom_earth_target_y,
+                     earth->velocity.x, earth->velocity.y);
+        } else if(ev->to_state == STATE_END_FADE) {
+            TraceLog(LOG_INFO, "Starting transition to end fade");
+        } else if(ev->to_state == STATE_END_CHOICE) {
+            TraceLog(LOG_INFO, "Moving to end choice");
+        }
+    }
+}
+
+// Silent games still pick their explosion sounds, so the effects stream
+// stays in step with games that play them
+static void PlayGameSound(const Game* game, int sound_idx) {
+    if(game->has_sound) { PlayIndexedSound(sound_idx); }
+}
+
+static void PlayGameEventSounds(Game* game) {
+    const GameAssets* assets = game->assets;
+    const GameEvents* events = &game->events;
+    for(int n = 0; n < sb_count(events->flare_fired); n++) {
+        PlayGameSound(game, assets->sound_flare);
+    }
+    for(int n = 0; n < sb_count(events->asteroid_destroyed); n++) {
+        PlayGameSound(game, assets->sound_explosions[RandomInt(&game->effects_random, 0, 2)]);
+    }
+    for(int n = 0; n < sb_count(events->earth_hit); n++) {
+        PlayGameSound(game, assets->sound_explosions[RandomInt(&game->effects_random, 0, 2)]);
+        PlayGameSound(game, events->earth_hit[n].hit_by == HIT_BY_FLARE ? assets->sound_scorched_flare : assets->sound_scorched_asteroid);
+    }
+    for(int n = 0; n < sb_count(events->state_changed); n++) {
+        if(events->state_changed[n].to_state == STATE_PLAYING) { PlayGameSound(game, assets->sound_start); }
+        if(events->state_changed[n].to_state == STATE_END_FADE) { PlayGameSound(game, assets->sound_end); }
+    }
+}
+
+static void ScoreGameEvents(Game* game) {
+    const GameEvents* events = &game->events;
+    // A new game starts the tallies over before this step's events count
+    for(int n = 0; n < sb_count(events->state_changed); n++) {
+        if(events->state_changed[n].to_state == STATE_PLAYING) {
+            game->asteroids_destroyed = 0;
+            game->flares_fired = 0;
+        }
+    }
+    for(int n = 0; n < sb_count(events->asteroid_destroyed); n++) {
+        game->asteroids_destroyed += events->asteroid_destroyed[n].hit_by == HIT_BY_ASTEROID ? 2 : 1;
+    }
+    game->flares_fired += sb_count(events->flare_fired);
+    for(int n = 0; n < sb_count(events->earth_hit); n++) {
+        game->is_earth_killed_by_flare = events->earth_hit[n].hit_by == HIT_BY_FLARE;
+        game->end_message = game->is_earth_killed_by_flare ? "You killed the Earth after just %.1f years"
+                                                           : "You kept Earth alive for %.1f years";
+    }
+}
+
+static void EmitExplosionDebris(Game* game, Vector2 pos) {
+    ParticleBurst debris = {
+        .x = pos.x,
+        .y = pos.y,
+        .count = game->quality_level >= QUALITY_FEWER_DEBRIS ? game->debris_per_explosion / shed_debris_divisor
+                                                             : game->debris_per_explosion,
+        .min_speed = 30.f,
+        .max_speed = 120.f,
+        .min_life = 0.4f,
+        .max_life = 1.f,
+        .color = explosion_tint
+    };
+    EmitParticles(&game->debris, &debris);
+}
+
+static void EmitGameEventEffects(Game* game) {
+    const GameEvents* events = &game->events;
+    for(int n = 0; n < sb_count(events->asteroid_destroyed); n++) {
+        const AsteroidDestroyedEvent* ev = &events->asteroid_destroyed[n];
+        EmitExplosionDebris(game, ev->pos);
+        if(ev->hit_by == HIT_BY_ASTEROID) { EmitExplosionDebris(game, ev->other_pos); }
+    }
+    for(int n = 0; n < sb_count(events->earth_hit); n++) {
+        EmitExplosionDebris(game, events->earth_hit[n].pos);
+    }
+}
+
+static void DrainGameEvents(Game* game) {
+    if(CountGameEvents(&game->events) == 0) { return; }
+    LogGameEvents(game);
+    PlayGameEventSounds(game);
+    ScoreGameEvents(game);
+    EmitGameEventEffects(game);
+    ClearGameEvents(&game->events);
+}
+
+
+void InitGame(Game* game, const GameAssets* assets, const GameConfig* config) {
+    *game = Game();
+    game->assets = assets;
+    game->state = STATE_TITLE;
+
+    // The playfield lives in world space, and the screen looks at it
+    // through a camera centred on the Sun
+    game->screen_w = config->screen_w;
+    game->screen_h = config->screen_h;
+    game->world_w = (int) (config->screen_w * config->world_scale);
+    game->world_h = (int) (config->screen_h * config->world_scale);
+    game->world_diam = sqrtf(((float) game->world_w * game->world_w) + ((float) game->world_h * game->world_h));
+
+    game->sun_sprite = CreateSprite(game, TEXTURE_IDX_SUN);
+    game->sun_sprite.dest_rect.x = game->world_w / 2.f;
+    game->sun_sprite.dest_rect.y = game->world_h / 2.f;
+    game->earth_sprite = CreateSprite(game, TEXTURE_IDX_EARTH);
+    // For collisions
+    game->sun_pos = { .x = game->sun_sprite.dest_rect.x, .y = game->sun_sprite.dest_rect.y };
+    game->sun_radius = game->sun_sprite.dest_rect.width / 3.f;
+
+    game->camera = { .offset = { .x = config->screen_w / 2.f, .y = config->screen_h / 2.f },
+                     .target = { .x = game->sun_sprite.dest_rect.x, .y = game->sun_sprite.dest_rect.y },
+                     .rotation = 0.f, .zoom = config->camera_zoom };
+
+    SeedRandomStream(&game->spawn_random, config->seed, RANDOM_STREAM_SPAWN);
+    SeedRandomStream(&game->effects_random, config->seed, RANDOM_STREAM_EFFECTS);
+    InitSpatialGrid(&game->collision_grid, (float) game->world_w, (float) game->world_h, COLLISION_CELL_SIZE);
+    InitSpawnScheduler(&game->spawner);
+    if(config->waves_filename != nullptr) { LoadSpawnRules(&game->spawner, config->waves_filename); }
+    InitParticles(&game->debris, debris_drag, config->seed);
+    game->debris_per_explosion = config->debris_per_explosion;
+    InitStarField(&game->star_field, config->star_count, (float) config->screen_w, (float) config->screen_h, config->seed);
+    InitTimeline(&game->timeline);
+    InitTimerWheel(&game->lifetimes, lifetime_tick, game->timeline.sim_time);
+    game->title_fade_alpha = 255.f;
+
+    // Title and end screens are static, so their text is drawn once into
+    // layers and only faded afterwards
+    game->has_view = config->has_view;
+    game->has_sound = config->has_sound;
+    if(game->has_view) {
+        SetCullView(GfxCameraView(game->camera));
+        InitTextLayer(&game->title_layer, config->screen_w, config->screen_h);
+        InitTextLayer(&game->end_layer, config->screen_w, config->screen_h);
+        InitTextLayer(&game->end_choice_layer, config->screen_w, config->screen_h);
+    }
+}
+
+void FreeGame(Game* game) {
+    sb_free(game->sprites);
+    game->sprites = nullptr;
+    FreeSpatialGrid(&game->collision_grid);
+    FreeSpawnScheduler(&game->spawner);
+    FreeTimerWheel(&game->lifetimes);
+    FreeStarField(&game->star_field);
+    FreeParticles(&game->debris);
+    FreeGameEvents(&game->events);
+    if(game->has_view) {
+        UnloadTextLayer(&game->title_layer);
+        UnloadTextLayer(&game->end_layer);
+        UnloadTextLayer(&game->end_choice_layer);
+    }
+    sb_free(game->distant_xs);
+    sb_free(game->distant_ys);
+    sb_free(game->distant_colors);
+    game->distant_xs = nullptr;
+    game->distant_ys = nullptr;
+    game->distant_colors = nullptr;
+}
+
+void UpdateGame(Game* game, const FrameInput* input) {
+    if(game->frame_index == 0) {
+        game->mouse_init_x = input->mouse_x;
+        game->mouse_init_y = input->mouse_y;
+    }
+    game->has_latched_aim = false;
+    STATE_HANDLERS[game->state].update(game, input);
+    DrainGameEvents(game);
+    game->frame_index++;
+}
+
+void LatchGameAim(Game* game, int mouse_x, int mouse_y) {
+    if(game->state != STATE_TITLE && game->state != STATE_TITLE_FADE && game->state != STATE_PLAYING) { return; }
+    Vector2 mouse_dir = GetAimDirection(game, mouse_x, mouse_y);
+    game->latched_target_x = (game->world_diam * mouse_dir.x) + game->sun_sprite.dest_rect.x;
+    game->latched_target_y = (game->world_diam * mouse_dir.y) + game->sun_sprite.dest_rect.y;
+    game->has_latched_aim = true;
+}
+
+void DrawGame(Game* game) {
+    GfxBeginFrame(COLOR_BACKGROUND);
+    STATE_HANDLERS[game->state].draw(game);
+    GfxEndFrame();
+}
+
+void SetGameQuality(Game* game, int level) {
+    game->quality_level = level;
+}
+
+void ChangeGameState(Game* game, int state) {
+    const GameStateHandlers* from = &STATE_HANDLERS[game->state];
+    const GameStateHandlers* to = &STATE_HANDLERS[state];
+    PushStateChanged(&game->events, { .from_state = game->state, .to_state = state });
+    if(from->exit != nullptr) { from->exit(game); }
+    game->state = state;
+    if(to->enter != nullptr) { to->enter(game); }
+}
+
+const char* GetGameStateName(int state) {
+    return state >= 0 && state < STATE_COUNT ? STATE_HANDLERS[state].name : "unknown";
+}
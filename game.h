@@ -0,0 +1,176 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "raylib.h"
+#include "events.h"
+#include "input.h"
+#include "orbit.h"
+#include "particles.h"
+#include "random.h"
+#include "spatialgrid.h"
+#include "spawner.h"
+#include "starfield.h"
+#include "textlayer.h"
+#include "timerwheel.h"
+
+
+// One game of Solar Commander: the solar system, the sprites in play and
+// the screen it is on. Screens are states in a table of enter, update,
+// draw and exit handlers; each frame runs only the handlers of the active
+// state, and a state change runs the old state's exit and the new state's
+// enter straight away.
+//
+// The simulation reports what happened through a per-step event buffer;
+// sounds, log lines, the score and explosion debris are all driven from it
+// after the step, never from inside the collision checks.
+//
+// Assets are loaded once and shared by every game. The text layers that
+// make up the view are only created when the game is drawn, so headless
+// games can run without a renderer. A game without a view or sound touches
+// no global state, so many can run at once on different threads.
+const int STATE_TITLE = 0;
+const int STATE_TITLE_FADE = 1;
+const int STATE_PLAYING = 2;
+const int STATE_END_ZOOM = 3;
+const int STATE_END_FADE = 4;
+const int STATE_END_CHOICE = 5;
+const int STATE_COUNT = 6;
+
+// Sprite types are texture indexes; dead sprites have their type negated
+const int TEXTURE_IDX_SUN = 0;
+const int TEXTURE_IDX_EARTH = 1;
+const int TEXTURE_IDX_FLARE = 2;
+const int TEXTURE_IDX_ASTEROID = 3;
+const int TEXTURE_IDX_SCORCHED = 4;
+const int TEXTURE_IDX_EXPLOSION = 5;
+const int TEXTURE_COUNT = 6;
+
+const float END_ZOOM_SCALE_TARGET = 4.f;
+const float FLARE_SPEED = 250.f;        // Pixels per second, out from the Sun
+
+struct Sprite {
+    int type;
+    Texture2D texture;
+    Vector2 origin;
+    Rectangle src_rect, dest_rect;
+    Vector2 velocity;
+    float rotation;
+    float rotation_delta;
+    float scale;
+    Color tint;
+    double expiry_time;         // Sim time the lifetime timer is due
+    unsigned int lifetime_serial;   // Matches the live timer, 0 for none
+};
+
+struct GameAssets {
+    Texture2D textures[TEXTURE_COUNT];
+    int sound_start;
+    int sound_flare;
+    int sound_scorched_asteroid;
+    int sound_scorched_flare;
+    int sound_end;
+    int sound_explosions[3];
+};
+
+struct GameConfig {
+    unsigned int seed;
+    int screen_w;
+    int screen_h;
+    float world_scale;          // Playfield size as a multiple of the screen
+    float camera_zoom;
+    int star_count;
+    const char* waves_filename;
+    int debris_per_explosion;
+    bool has_view;              // Create the text layers for drawing
+    bool has_sound;             // Play sounds through the audio thread
+};
+
+struct Game {
+    const GameAssets* assets;
+    int state;
+    int frame_index;
+    GameEvents events;          // Raised by this step, drained at its end
+
+    // Playfield
+    int world_w;
+    int world_h;
+    float world_diam;
+    int screen_w;
+    int screen_h;
+    Camera2D camera;
+
+    // Simulation
+    Sprite sun_sprite;
+    Sprite earth_sprite;
+    Sprite* sprites;            // stretchy_buffer
+    RandomStream spawn_random;
+    RandomStream effects_random;
+    SpatialGrid collision_grid;
+    TimerWheel lifetimes;       // Despawns sprites; ids are sprite indexes
+    unsigned int next_lifetime_serial;
+    SpawnScheduler spawner;
+    ParticleSystem debris;      // Visual only, never collides
+    int debris_per_explosion;
+    StarField star_field;
+    Timeline timeline;
+    Vector2 sun_pos;
+    float sun_radius;
+    Vector2 earth_pos;
+    float earth_radius;
+
+    // Aiming
+    int mouse_init_x;
+    int mouse_init_y;
+    bool mouse_has_moved;
+    float mouse_target_x;
+    float mouse_target_y;
+
+    // Screens
+    float title_fade_alpha;
+    double earth_revolve_count;         // Presented as "years"
+    double max_earth_revolve_count;
+    int asteroids_destroyed;
+    int flares_fired;
+    bool is_earth_killed_by_flare;
+    float end_zoom_earth_target_x;
+    float end_zoom_earth_target_y;
+    float end_fade_alpha;
+    const char* end_message;
+
+    // View
+    bool has_view;
+    bool has_sound;
+    bool has_latched_aim;       // Aim line from a cursor read after the step
+    float latched_target_x;
+    float latched_target_y;
+    int quality_level;          // QUALITY_* from governor.h; drawing and logging only
+    float* distant_xs;          // stretchy_buffers, scratch for flat sprites
+    float* distant_ys;
+    Color* distant_colors;
+    TextLayer title_layer;
+    TextLayer end_layer;
+    TextLayer end_choice_layer;
+    CachedText hud_years_text;
+    CachedText end_years_text;
+    CachedText record_years_text;
+};
+
+void LoadGameAssets(GameAssets* assets);
+void UnloadGameAssets(GameAssets* assets);
+
+void InitGame(Game* game, const GameAssets* assets, const GameConfig* config);
+void FreeGame(Game* game);
+void UpdateGame(Game* game, const FrameInput* input);
+// Draws a whole frame, from GfxBeginFrame to GfxEndFrame
+void DrawGame(Game* game);
+// Points the aim line at a fresher cursor position for this frame's
+// drawing only; flares still fly where the step's input aimed them
+void LatchGameAim(Game* game, int mouse_x, int mouse_y);
+// Sheds optional drawing and logging; the simulation is the same at any level
+void SetGameQuality(Game* game, int level);
+
+void ChangeGameState(Game* game, int state);
+const char* GetGameStateName(int state);
+int CountLiveSprites(const Game* game);
+
+#endif // GAME_H
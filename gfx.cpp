@@ -0,0 +1,337 @@
+#include <chrono>
+#include <math.h>
+#include "gfx.h"
+#include "rlgl_lite.h"
+#include "softraster.h"
+
+
+static int gfx_backend = GFX_BACKEND_RAYLIB;
+static int gfx_width = 0;
+static int gfx_height = 0;
+static bool is_camera_active = false;       // Software backend transforms by hand
+static Camera2D active_camera;
+static const int LINES_PER_BATCH = 4096;
+static const int QUADS_PER_BATCH = 2048;
+static std::chrono::steady_clock::time_point frame_start;
+static int frame_count = 0;
+static double frame_seconds = 0.;
+static double max_frame_ms = 0.;
+static std::chrono::steady_clock::time_point submit_time;
+
+void InitGfx(int backend, int width, int height) {
+    gfx_backend = backend;
+    gfx_width = width;
+    gfx_height = height;
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        InitSoftRaster(width, height);
+    }
+}
+
+void CloseGfx() {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        CloseSoftRaster();
+    }
+}
+
+int GetGfxBackend() {
+    return gfx_backend;
+}
+
+Texture2D GfxLoadTexture(const char* filename) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) { return SoftLoadTexture(filename); }
+    return LoadTexture(filename);
+}
+
+void GfxUnloadTexture(Texture2D texture) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        SoftUnloadTexture(texture);
+    } else {
+        UnloadTexture(texture);
+    }
+}
+
+void GfxBeginFrame(Color background) {
+    frame_start = std::chrono::steady_clock::now();
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        SoftClear(background);
+    } else {
+        BeginDrawing();
+        ClearBackground(background);
+    }
+}
+
+void GfxEndFrame() {
+    // Counts draw submission only, not the raylib swap and frame wait
+    double frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+    frame_count++;
+    frame_seconds += frame_ms / 1000.;
+    if(frame_ms > max_frame_ms) { max_frame_ms = frame_ms; }
+    submit_time = std::chrono::steady_clock::now();
+    if(gfx_backend != GFX_BACKEND_SOFTWARE) {
+        EndDrawing();
+    }
+}
+
+double GetGfxSubmitTime() {
+    return std::chrono::duration<double>(submit_time.time_since_epoch()).count();
+}
+
+void LogGfxStats() {
+    TraceLog(LOG_INFO, "Gfx (%s): %d frames drawn in %.2f ms (%.3f ms avg, %.3f ms max)",
+             gfx_backend == GFX_BACKEND_SOFTWARE ? "software" : "raylib", frame_count, frame_seconds * 1000.,
+             frame_count > 0 ? frame_seconds * 1000. / frame_count : 0., max_frame_ms);
+}
+
+static inline Vector2 SoftCameraPoint(float x, float y) {
+    if(!is_camera_active) { return { x, y }; }
+    return GfxWorldToScreen(active_camera, { x, y });
+}
+
+void GfxPixel(int x, int y, Color color) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        Vector2 p = SoftCameraPoint((float) x, (float) y);
+        SoftDrawPixel((int) floorf(p.x), (int) floorf(p.y), color);
+    } else {
+        DrawPixel(x, y, color);
+    }
+}
+
+void GfxLine(int start_x, int start_y, int end_x, int end_y, Color color) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        Vector2 start = SoftCameraPoint((float) start_x, (float) start_y);
+        Vector2 end = SoftCameraPoint((float) end_x, (float) end_y);
+        SoftDrawLine((int) floorf(start.x), (int) floorf(start.y), (int) floorf(end.x), (int) floorf(end.y), color);
+    } else {
+        DrawLine(start_x, start_y, end_x, end_y, color);
+    }
+}
+
+void GfxLineBatch(const float* xs, const float* ys, int count, float dx, float dy, Color color) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        if(is_camera_active) {
+            for(int i = 0; i < count; i++) {
+                GfxLine((int) xs[i], (int) ys[i], (int) xs[i] + (int) dx, (int) ys[i] + (int) dy, color);
+            }
+            return;
+        }
+        for(int i = 0; i < count; i++) {
+            const int x = (int) xs[i];
+            const int y = (int) ys[i];
+            if(dx == 1.f && dy == 1.f) {
+                SoftDrawPixel(x, y, color);
+            } else {
+                SoftDrawLine(x, y, x + (int) dx, y + (int) dy, color);
+            }
+        }
+        return;
+    }
+
+    // One rlgl submission per chunk that fits raylib's vertex buffer
+    for(int start = 0; start < count; start += LINES_PER_BATCH) {
+        int end = start + LINES_PER_BATCH < count ? start + LINES_PER_BATCH : count;
+        if(rlCheckBufferLimit(2 * (end - start))) { rlglDraw(); }
+        rlBegin(RL_LINES);
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        for(int i = start; i < end; i++) {
+            const float x = (float) (int) xs[i];
+            const float y = (float) (int) ys[i];
+            rlVertex2f(x, y);
+            rlVertex2f(x + dx, y + dy);
+        }
+        rlEnd();
+    }
+}
+
+void GfxQuadBatch(const float* xs, const float* ys, const Color* colors, int count, float size) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        // Camera applied by hand, with the rotation worked out once per batch
+        const Camera2D camera = is_camera_active ? active_camera : Camera2D { { 0.f, 0.f }, { 0.f, 0.f }, 0.f, 1.f };
+        const float c = cosf(DEG2RAD * camera.rotation) * camera.zoom;
+        const float s = sinf(DEG2RAD * camera.rotation) * camera.zoom;
+        const int side = (int) ceilf(size * camera.zoom);
+        const float half = side / 2.f;
+        for(int i = 0; i < count; i++) {
+            const float x = xs[i] - camera.target.x;
+            const float y = ys[i] - camera.target.y;
+            const float screen_x = x * c - y * s + camera.offset.x;
+            const float screen_y = x * s + y * c + camera.offset.y;
+            SoftFillRect((int) floorf(screen_x - half), (int) floorf(screen_y - half), side, side, colors[i]);
+        }
+        return;
+    }
+
+    // One rlgl submission per chunk that fits raylib's vertex buffer. Like
+    // DrawRectangle, the quads sample raylib's shapes texture; without it
+    // they would join the draw call of the last sprite texture
+    const float half = size / 2.f;
+    const Texture2D shapes = GetShapesTexture();
+    const Rectangle shapes_rec = GetShapesTextureRec();
+    const float u0 = shapes_rec.x / shapes.width;
+    const float v0 = shapes_rec.y / shapes.height;
+    const float u1 = (shapes_rec.x + shapes_rec.width) / shapes.width;
+    const float v1 = (shapes_rec.y + shapes_rec.height) / shapes.height;
+    for(int start = 0; start < count; start += QUADS_PER_BATCH) {
+        int end = start + QUADS_PER_BATCH < count ? start + QUADS_PER_BATCH : count;
+        if(rlCheckBufferLimit(4 * (end - start))) { rlglDraw(); }
+        rlEnableTexture(shapes.id);
+        rlBegin(RL_QUADS);
+        for(int i = start; i < end; i++) {
+            rlColor4ub(colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+            rlTexCoord2f(u0, v0);
+            rlVertex2f(xs[i] - half, ys[i] - half);
+            rlTexCoord2f(u0, v1);
+            rlVertex2f(xs[i] - half, ys[i] + half);
+            rlTexCoord2f(u1, v1);
+            rlVertex2f(xs[i] + half, ys[i] + half);
+            rlTexCoord2f(u1, v0);
+            rlVertex2f(xs[i] + half, ys[i] - half);
+        }
+        rlEnd();
+        rlDisableTexture();
+    }
+}
+
+void GfxTexturePro(Texture2D texture, Rectangle src_rect, Rectangle dest_rect, Vector2 origin, float rotation, Color tint) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        if(is_camera_active) {
+            Vector2 pivot = GfxWorldToScreen(active_camera, { dest_rect.x, dest_rect.y });
+            dest_rect = { pivot.x, pivot.y, dest_rect.width * active_camera.zoom, dest_rect.height * active_camera.zoom };
+            origin = { origin.x * active_camera.zoom, origin.y * active_camera.zoom };
+            rotation += active_camera.rotation;
+        }
+        SoftDrawTexturePro(texture, src_rect, dest_rect, origin, rotation, tint);
+    } else {
+        DrawTexturePro(texture, src_rect, dest_rect, origin, rotation, tint);
+    }
+}
+
+void GfxTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        // Same mapping raylib's DrawTextureEx uses
+        Rectangle src_rect = { 0.f, 0.f, (float) texture.width, (float) texture.height };
+        Rectangle dest_rect = { position.x, position.y, texture.width * scale, texture.height * scale };
+        GfxTexturePro(texture, src_rect, dest_rect, { 0.f, 0.f }, rotation, tint);
+    } else {
+        DrawTextureEx(texture, position, rotation, scale, tint);
+    }
+}
+
+void GfxText(const char* text, int x, int y, int font_size, Color color) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        SoftDrawText(text, x, y, font_size, color);
+    } else {
+        DrawText(text, x, y, font_size, color);
+    }
+}
+
+void GfxBeginCamera(Camera2D camera) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        active_camera = camera;
+        is_camera_active = true;
+    } else {
+        BeginMode2D(camera);
+    }
+}
+
+void GfxEndCamera() {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        is_camera_active = false;
+    } else {
+        EndMode2D();
+    }
+}
+
+Vector2 GfxWorldToScreen(Camera2D camera, Vector2 world) {
+    // Same order as raylib's camera matrix: move target to the origin, scale,
+    // rotate, then move to the offset
+    const float c = cosf(DEG2RAD * camera.rotation);
+    const float s = sinf(DEG2RAD * camera.rotation);
+    const float x = (world.x - camera.target.x) * camera.zoom;
+    const float y = (world.y - camera.target.y) * camera.zoom;
+    return { x * c - y * s + camera.offset.x, x * s + y * c + camera.offset.y };
+}
+
+Vector2 GfxScreenToWorld(Camera2D camera, Vector2 screen) {
+    const float c = cosf(DEG2RAD * camera.rotation);
+    const float s = sinf(DEG2RAD * camera.rotation);
+    const float x = screen.x - camera.offset.x;
+    const float y = screen.y - camera.offset.y;
+    return { (x * c + y * s) / camera.zoom + camera.target.x, (-x * s + y * c) / camera.zoom + camera.target.y };
+}
+
+Rectangle GfxCameraView(Camera2D camera) {
+    const Vector2 corners[4] = {
+        GfxScreenToWorld(camera, { 0.f, 0.f }),
+        GfxScreenToWorld(camera, { (float) gfx_width, 0.f }),
+        GfxScreenToWorld(camera, { 0.f, (float) gfx_height }),
+        GfxScreenToWorld(camera, { (float) gfx_width, (float) gfx_height })
+    };
+    float min_x = corners[0].x, max_x = corners[0].x, min_y = corners[0].y, max_y = corners[0].y;
+    for(int i = 1; i < 4; i++) {
+        min_x = fminf(min_x, corners[i].x);
+        max_x = fmaxf(max_x, corners[i].x);
+        min_y = fminf(min_y, corners[i].y);
+        max_y = fmaxf(max_y, corners[i].y);
+    }
+    return { min_x, min_y, max_x - min_x, max_y - min_y };
+}
+
+GfxLayer GfxLoadLayer(int width, int height) {
+    GfxLayer layer = GfxLayer();
+    layer.width = width;
+    layer.height = height;
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        layer.texture = SoftCreateTexture(width, height);
+    } else {
+        layer.target = LoadRenderTexture(width, height);
+    }
+    return layer;
+}
+
+void GfxUnloadLayer(GfxLayer layer) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        SoftUnloadTexture(layer.texture);
+    } else {
+        UnloadRenderTexture(layer.target);
+    }
+}
+
+void GfxBeginLayer(GfxLayer layer) {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        SoftBeginTarget(layer.texture);
+    } else {
+        BeginTextureMode(layer.target);
+        ClearBackground(BLANK);
+    }
+}
+
+void GfxEndLayer() {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        SoftEndTarget();
+    } else {
+        EndTextureMode();
+    }
+}
+
+void GfxDrawLayer(GfxLayer layer, int x, int y, Color tint) {
+    Rectangle dest_rect = { (float) x, (float) y, (float) layer.width, (float) layer.height };
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) {
+        Rectangle src_rect = { 0.f, 0.f, (float) layer.width, (float) layer.height };
+        SoftDrawTexturePro(layer.texture, src_rect, dest_rect, { 0.f, 0.f }, 0.f, tint);
+    } else {
+        // Render textures come out upside down in OpenGL
+        Rectangle src_rect = { 0.f, 0.f, (float) layer.width, (float) -layer.height };
+        DrawTexturePro(layer.target.texture, src_rect, dest_rect, { 0.f, 0.f }, 0.f, tint);
+    }
+}
+
+Image GfxGetFrameImage() {
+    if(gfx_backend == GFX_BACKEND_SOFTWARE) { return SoftGetFrameImage(); }
+    Image empty = Image();
+    return empty;
+}
+
+void GfxExportFrame(const char* filename) {
+    if(gfx_backend != GFX_BACKEND_SOFTWARE) { return; }
+    ExportImage(SoftGetFrameImage(), filename);
+}
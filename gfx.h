@@ -0,0 +1,65 @@
+#ifndef GFX_H
+#define GFX_H
+
+#include "raylib.h"
+
+
+// Thin drawing layer between the game and the renderer. The raylib backend
+// forwards straight to raylib's OpenGL path. The software backend draws into
+// an in-memory framebuffer on the CPU, so frames can be rendered and timed
+// on machines without a GPU or window.
+const int GFX_BACKEND_RAYLIB = 0;
+const int GFX_BACKEND_SOFTWARE = 1;
+
+// Offscreen layer: drawn into once, then composited as a single quad
+struct GfxLayer {
+    int width;
+    int height;
+    RenderTexture2D target;     // raylib backend
+    Texture2D texture;          // Software backend
+};
+
+void InitGfx(int backend, int width, int height);
+void CloseGfx();
+int GetGfxBackend();
+
+Texture2D GfxLoadTexture(const char* filename);
+void GfxUnloadTexture(Texture2D texture);
+
+void GfxBeginFrame(Color background);
+void GfxEndFrame();
+// Steady clock seconds when the last frame was handed to the swap
+double GetGfxSubmitTime();
+void LogGfxStats();
+
+void GfxPixel(int x, int y, Color color);
+void GfxLine(int start_x, int start_y, int end_x, int end_y, Color color);
+// Draws count segments from (xs[i], ys[i]) to (xs[i] + dx, ys[i] + dy) in one batch
+void GfxLineBatch(const float* xs, const float* ys, int count, float dx, float dy, Color color);
+// Draws count solid size x size squares centred on (xs[i], ys[i]) in one batch
+void GfxQuadBatch(const float* xs, const float* ys, const Color* colors, int count, float size);
+void GfxTexturePro(Texture2D texture, Rectangle src_rect, Rectangle dest_rect, Vector2 origin, float rotation, Color tint);
+void GfxTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint);
+void GfxText(const char* text, int x, int y, int font_size, Color color);
+
+// World-space drawing. Between GfxBeginCamera and GfxEndCamera the pixel,
+// line and texture calls take world coordinates, mapped to the frame
+// through a raylib Camera2D. Text and layers always draw in screen space.
+void GfxBeginCamera(Camera2D camera);
+void GfxEndCamera();
+Vector2 GfxWorldToScreen(Camera2D camera, Vector2 world);
+Vector2 GfxScreenToWorld(Camera2D camera, Vector2 screen);
+Rectangle GfxCameraView(Camera2D camera);      // World-space box the frame covers
+
+GfxLayer GfxLoadLayer(int width, int height);
+void GfxUnloadLayer(GfxLayer layer);
+// Draws between these go into the layer, which starts out transparent
+void GfxBeginLayer(GfxLayer layer);
+void GfxEndLayer();
+void GfxDrawLayer(GfxLayer layer, int x, int y, Color tint);
+
+// Software backend only
+Image GfxGetFrameImage();                   // Borrowed view of the framebuffer
+void GfxExportFrame(const char* filename);  // PNG dump of the framebuffer
+
+#endif // GFX_H
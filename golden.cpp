@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <string.h>
+#include "golden.h"
+#include "gfx.h"
+#include "raylib.h"
+#include "stretchy_buffer.h"
+
+
+struct GoldenResult {
+    char name[64];
+    bool passed;
+};
+
+static const char* golden_dir = nullptr;
+static bool golden_update = false;
+static int golden_tolerance = 0;
+static int golden_max_bad_pixels = 0;
+static GoldenResult* golden_results = nullptr;
+
+void InitGoldenHarness(const char* dir, bool update, int tolerance, int max_bad_pixels) {
+    golden_dir = dir;
+    golden_update = update;
+    golden_tolerance = tolerance;
+    golden_max_bad_pixels = max_bad_pixels;
+}
+
+bool IsGoldenCheckpointDone(const char* name) {
+    for(int i = 0; i < sb_count(golden_results); i++) {
+        if(strcmp(golden_results[i].name, name) == 0) { return true; }
+    }
+    return false;
+}
+
+static bool CompareWithGolden(const char* name, Image frame) {
+    const char* golden_file = TextFormat("%s/%s.png", golden_dir, name);
+    Image golden = LoadImage(golden_file);
+    if(golden.data == nullptr) {
+        TraceLog(LOG_ERROR, "Golden %s: missing %s", name, golden_file);
+        ExportImage(frame, TextFormat("%s/%s.actual.png", golden_dir, name));
+        return false;
+    }
+    ImageFormat(&golden, UNCOMPRESSED_R8G8B8A8);
+    if(golden.width != frame.width || golden.height != frame.height) {
+        TraceLog(LOG_ERROR, "Golden %s: size %dx%d, frame is %dx%d", name, golden.width, golden.height, frame.width, frame.height);
+        UnloadImage(golden);
+        return false;
+    }
+
+    // Diff mask: red where a channel is off by more than the tolerance, dimmed frame elsewhere
+    const int pixel_count = frame.width * frame.height;
+    const Color* expected = (const Color*) golden.data;
+    const Color* actual = (const Color*) frame.data;
+    Color* diff = (Color*) malloc(sizeof(Color) * pixel_count);
+    int bad_pixels = 0;
+    int worst = 0;
+    for(int i = 0; i < pixel_count; i++) {
+        int dr = abs(expected[i].r - actual[i].r);
+        int dg = abs(expected[i].g - actual[i].g);
+        int db = abs(expected[i].b - actual[i].b);
+        int d = dr > dg ? (dr > db ? dr : db) : (dg > db ? dg : db);
+        if(d > worst) { worst = d; }
+        if(d > golden_tolerance) {
+            bad_pixels++;
+            diff[i] = RED;
+        } else {
+            diff[i] = { (unsigned char) (actual[i].r / 4), (unsigned char) (actual[i].g / 4), (unsigned char) (actual[i].b / 4), 255 };
+        }
+    }
+    UnloadImage(golden);
+
+    const bool passed = bad_pixels <= golden_max_bad_pixels;
+    if(passed) {
+        TraceLog(LOG_INFO, "Golden %s: ok (%d pixels over tolerance, worst channel delta %d)", name, bad_pixels, worst);
+    } else {
+        TraceLog(LOG_ERROR, "Golden %s: FAILED, %d pixels over tolerance %d (allowed %d), worst channel delta %d",
+                 name, bad_pixels, golden_tolerance, golden_max_bad_pixels, worst);
+        Image diff_image = { diff, frame.width, frame.height, 1, UNCOMPRESSED_R8G8B8A8 };
+        ExportImage(frame, TextFormat("%s/%s.actual.png", golden_dir, name));
+        ExportImage(diff_image, TextFormat("%s/%s.diff.png", golden_dir, name));
+    }
+    free(diff);
+    return passed;
+}
+
+void GoldenCheckpoint(const char* name) {
+    if(golden_dir == nullptr || IsGoldenCheckpointDone(name)) { return; }
+    GoldenResult result = GoldenResult();
+    strncpy(result.name, name, sizeof(result.name) - 1);
+
+    Image frame = GfxGetFrameImage();
+    if(frame.data == nullptr) {
+        TraceLog(LOG_ERROR, "Golden %s: no software framebuffer to capture", name);
+        result.passed = false;
+    } else if(golden_update) {
+        ExportImage(frame, TextFormat("%s/%s.png", golden_dir, name));
+        TraceLog(LOG_INFO, "Golden %s: updated", name);
+        result.passed = true;
+    } else {
+        result.passed = CompareWithGolden(name, frame);
+    }
+    sb_push(golden_results, result);
+}
+
+int FinishGoldenHarness(const char** expected_names, int expected_count) {
+    if(golden_dir == nullptr) { return 0; }
+    int failures = 0;
+    for(int i = 0; i < sb_count(golden_results); i++) {
+        if(!golden_results[i].passed) { failures++; }
+    }
+    for(int i = 0; i < expected_count; i++) {
+        if(!IsGoldenCheckpointDone(expected_names[i])) {
+            TraceLog(LOG_ERROR, "Golden %s: checkpoint never reached", expected_names[i]);
+            failures++;
+        }
+    }
+    TraceLog(failures > 0 ? LOG_ERROR : LOG_INFO, "Golden: %d checkpoints, %d failed",
+             expected_count, failures);
+    sb_free(golden_results);
+    golden_results = nullptr;
+    golden_dir = nullptr;
+    return failures;
+}
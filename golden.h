@@ -0,0 +1,17 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+
+// Golden-image checks for the software renderer. A headless replay calls
+// GoldenCheckpoint at fixed points in the session; each captured frame is
+// compared against <dir>/<name>.png, allowing a per-channel tolerance. On a
+// mismatch the captured frame and a diff mask are written next to the
+// golden as <name>.actual.png and <name>.diff.png. In update mode the
+// goldens are rewritten instead.
+void InitGoldenHarness(const char* golden_dir, bool update, int tolerance, int max_bad_pixels);
+void GoldenCheckpoint(const char* name);
+bool IsGoldenCheckpointDone(const char* name);
+// Logs a summary and returns the number of failed or missing checkpoints
+int FinishGoldenHarness(const char** expected_names, int expected_count);
+
+#endif // GOLDEN_H
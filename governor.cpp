@@ -0,0 +1,85 @@
+#include <stdlib.h>
+#include "governor.h"
+#include "raylib.h"
+#include "stretchy_buffer.h"
+
+
+static const char* QUALITY_LEVEL_NAMES[QUALITY_LEVEL_COUNT] = {
+    "full", "fewer stars", "quiet log", "fewer debris", "simple sprites"
+};
+
+void InitQualityGovernor(QualityGovernor* governor, const GovernorConfig* config) {
+    *governor = QualityGovernor();
+    governor->config = *config;
+    if(governor->config.window_frames < 1) { governor->config.window_frames = 1; }
+    governor->level = QUALITY_FULL;
+    governor->samples = (float*) malloc(sizeof(float) * governor->config.window_frames);
+}
+
+void FreeQualityGovernor(QualityGovernor* governor) {
+    free(governor->samples);
+    sb_free(governor->changes);
+    *governor = QualityGovernor();
+}
+
+static void ChangeQualityLevel(QualityGovernor* governor, int level, float rolling_ms, int frame_index) {
+    const QualityChange change = {
+        .frame_index = frame_index,
+        .from_level = governor->level,
+        .to_level = level,
+        .rolling_ms = rolling_ms
+    };
+    sb_push(governor->changes, change);
+    TraceLog(LOG_INFO, "Quality: %s -> %s at frame %d, %.2f ms avg over %d frames against a %.2f ms budget",
+             QUALITY_LEVEL_NAMES[change.from_level], QUALITY_LEVEL_NAMES[level], frame_index, rolling_ms,
+             governor->sample_count, governor->config.budget_ms);
+    governor->level = level;
+    governor->frames_since_change = 0;
+}
+
+int UpdateQualityGovernor(QualityGovernor* governor, float frame_ms, int frame_index) {
+    const GovernorConfig* config = &governor->config;
+    GovernorStats* stats = &governor->stats;
+    stats->frames++;
+    stats->frames_at_level[governor->level]++;
+    if(frame_ms > config->budget_ms) { stats->over_budget++; }
+    if(config->budget_ms <= 0.f) { return governor->level; }
+
+    if(governor->sample_count == config->window_frames) {
+        governor->sample_sum -= governor->samples[governor->next_sample];
+    } else {
+        governor->sample_count++;
+    }
+    governor->samples[governor->next_sample] = frame_ms;
+    governor->sample_sum += frame_ms;
+    governor->next_sample = (governor->next_sample + 1) % config->window_frames;
+    governor->frames_since_change++;
+    if(governor->sample_count < config->window_frames) { return governor->level; }
+
+    const float rolling_ms = (float) (governor->sample_sum / governor->sample_count);
+    if(rolling_ms > stats->max_rolling_ms) { stats->max_rolling_ms = rolling_ms; }
+    if(rolling_ms > config->budget_ms * config->shed_ratio && governor->level < QUALITY_LEVEL_COUNT - 1 &&
+       governor->frames_since_change >= config->hold_frames) {
+        ChangeQualityLevel(governor, governor->level + 1, rolling_ms, frame_index);
+    } else if(rolling_ms < config->budget_ms * config->restore_ratio && governor->level > QUALITY_FULL &&
+              governor->frames_since_change >= config->hold_frames * 4) {
+        ChangeQualityLevel(governor, governor->level - 1, rolling_ms, frame_index);
+    }
+    return governor->level;
+}
+
+const char* GetQualityLevelName(int level) {
+    return level >= 0 && level < QUALITY_LEVEL_COUNT ? QUALITY_LEVEL_NAMES[level] : "unknown";
+}
+
+void LogQualityGovernorStats(const QualityGovernor* governor) {
+    const GovernorStats* stats = &governor->stats;
+    if(stats->frames == 0) { return; }
+    TraceLog(LOG_INFO, "Quality: %lld frames, %d over the %.2f ms budget, %.2f ms worst average, %d level changes",
+             stats->frames, stats->over_budget, governor->config.budget_ms, stats->max_rolling_ms, sb_count(governor->changes));
+    for(int level = 0; level < QUALITY_LEVEL_COUNT; level++) {
+        if(stats->frames_at_level[level] == 0) { continue; }
+        TraceLog(LOG_INFO, "Quality: %lld frames (%.1f%%) at %s", stats->frames_at_level[level],
+                 stats->frames_at_level[level] * 100. / stats->frames, QUALITY_LEVEL_NAMES[level]);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+
+// Watches how long frames take and sheds optional work when they run over
+// budget, one level at a time and in this order:
+//
+//   1  fewer stars      half of each star layer is drawn
+//   2  quiet log        collision log lines are skipped
+//   3  fewer debris     explosions throw a quarter of their debris
+//   4  simple sprites   sprites far from the Sun are drawn as flat quads
+//
+// Each level keeps everything the ones before it shed. Nothing here feeds
+// back into the simulation: stars still move, every collision still raises
+// its event, and debris has its own random stream, so a game plays out the
+// same at any level.
+//
+// The governor sheds a level when the average over the last window of
+// frames passes shed_ratio of the budget, and restores one when it falls
+// under restore_ratio. After a change it waits hold_frames before shedding
+// again, and four times that before restoring, so a single spike doesn't
+// make it flap. Every change is logged and kept.
+const int QUALITY_FULL = 0;
+const int QUALITY_FEWER_STARS = 1;
+const int QUALITY_QUIET_LOG = 2;
+const int QUALITY_FEWER_DEBRIS = 3;
+const int QUALITY_SIMPLE_SPRITES = 4;
+const int QUALITY_LEVEL_COUNT = 5;
+
+struct GovernorConfig {
+    float budget_ms;
+    float shed_ratio;           // Of the budget; shed above this
+    float restore_ratio;        // Of the budget; restore below this
+    int window_frames;          // Frames in the rolling average
+    int hold_frames;
+};
+
+struct QualityChange {
+    int frame_index;            // Game frame the change took effect on
+    int from_level;
+    int to_level;
+    float rolling_ms;           // The average that caused it
+};
+
+struct GovernorStats {
+    long long frames;
+    long long frames_at_level[QUALITY_LEVEL_COUNT];
+    int over_budget;            // Single frames past the budget
+    float max_rolling_ms;
+};
+
+struct QualityGovernor {
+    GovernorConfig config;
+    int level;
+    float* samples;             // Ring of window_frames frame times
+    int sample_count;
+    int next_sample;
+    double sample_sum;
+    int frames_since_change;
+    QualityChange* changes;     // stretchy_buffer
+    GovernorStats stats;
+};
+
+void InitQualityGovernor(QualityGovernor* governor, const GovernorConfig* config);
+void FreeQualityGovernor(QualityGovernor* governor);
+// Call once a frame with that frame's working time; returns the level for
+// the next one
+int UpdateQualityGovernor(QualityGovernor* governor, float frame_ms, int frame_index);
+
+const char* GetQualityLevelName(int level);
+void LogQualityGovernorStats(const QualityGovernor* governor);
+
+#endif // GOVERNOR_H
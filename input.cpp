@@ -0,0 +1,276 @@
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include "input.h"
+#include "raylib.h"
+#include "stretchy_buffer.h"
+
+
+#if defined(_WIN32)
+// The few user32 calls needed, declared here because windows.h clashes with
+// raylib's names
+struct OsPoint {
+    long x;
+    long y;
+};
+extern "C" __declspec(dllimport) int __stdcall GetCursorPos(OsPoint* point);
+extern "C" __declspec(dllimport) int __stdcall ScreenToClient(void* window, OsPoint* point);
+extern "C" __declspec(dllimport) short __stdcall GetAsyncKeyState(int key);
+extern "C" __declspec(dllimport) void* __stdcall GetForegroundWindow();
+static const int OS_KEY_LBUTTON = 0x01;
+#endif
+
+static const int SESSION_VERSION = 2;
+static const double max_click_lead = 0.05;         // Older presses get no lead
+
+static int input_source = INPUT_SOURCE_WINDOW;
+static float input_fixed_frame_time = 1.f / 60.f;
+static double headless_time = 0.;
+
+static FrameInput* replay_frames = nullptr;
+static int replay_cursor = 0;
+static unsigned int replay_seed = 0;
+
+static FILE* record_file = nullptr;
+static long record_header_pos = 0;
+static int record_frame_count = 0;
+static unsigned int record_seed = 0;
+
+static std::thread press_sampler;
+static std::atomic<bool> press_sampler_running(false);
+static std::atomic<double> last_press_time(0.);     // Steady clock seconds
+static double used_press_time = 0.;
+
+static double frame_sample_time = 0.;
+static double latch_time = 0.;
+static double click_time = 0.;                      // 0 when no timed click this frame
+#if defined(_WIN32)
+static long sample_cursor_x = 0;                    // Screen position at the frame sample
+static long sample_cursor_y = 0;
+#endif
+static InputLatencyStats latency_stats = InputLatencyStats();
+
+static double SteadySeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(_WIN32)
+static void PressSamplerMain() {
+    bool was_down = false;
+    while(press_sampler_running.load(std::memory_order_acquire)) {
+        bool is_down = (GetAsyncKeyState(OS_KEY_LBUTTON) & 0x8000) != 0;
+        if(is_down && !was_down) { last_press_time.store(SteadySeconds(), std::memory_order_release); }
+        was_down = is_down;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+#endif
+
+static void StartPressSampler() {
+#if defined(_WIN32)
+    if(press_sampler_running.load()) { return; }
+    press_sampler_running.store(true);
+    press_sampler = std::thread(PressSamplerMain);
+#endif
+}
+
+static void StopPressSampler() {
+    if(!press_sampler_running.load()) { return; }
+    press_sampler_running.store(false, std::memory_order_release);
+    press_sampler.join();
+}
+
+static bool LoadReplay(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if(file == nullptr) {
+        TraceLog(LOG_WARNING, "Could not open session %s", filename);
+        return false;
+    }
+    int version = 0, frame_count = 0;
+    if(fscanf(file, " SESSION %d seed=%u frames=%d", &version, &replay_seed, &frame_count) != 3 ||
+       version < 1 || version > SESSION_VERSION) {
+        TraceLog(LOG_WARNING, "Session %s has an unknown header", filename);
+        fclose(file);
+        return false;
+    }
+    for(int i = 0; i < frame_count; i++) {
+        FrameInput input = FrameInput();
+        int pressed = 0;
+        if(fscanf(file, " %f %lf %d %d %d", &input.frame_time, &input.time, &input.mouse_x, &input.mouse_y, &pressed) != 5 ||
+           (version >= 2 && fscanf(file, " %f", &input.click_lead) != 1)) {
+            TraceLog(LOG_WARNING, "Session %s ends early at frame %d of %d", filename, i, frame_count);
+            break;
+        }
+        input.mouse_pressed = pressed != 0;
+        sb_push(replay_frames, input);
+    }
+    fclose(file);
+    return true;
+}
+
+bool InitFrameInput(int source, float fixed_frame_time, const char* replay_filename) {
+    input_source = source;
+    input_fixed_frame_time = fixed_frame_time;
+    headless_time = 0.;
+    replay_cursor = 0;
+    if(source == INPUT_SOURCE_REPLAY) {
+        return LoadReplay(replay_filename);
+    }
+    if(source == INPUT_SOURCE_WINDOW) { StartPressSampler(); }
+    return true;
+}
+
+FrameInput NextFrameInput() {
+    FrameInput input = FrameInput();
+    if(input_source == INPUT_SOURCE_REPLAY) {
+        if(replay_cursor < sb_count(replay_frames)) {
+            input = replay_frames[replay_cursor++];
+        } else if(sb_count(replay_frames) > 0) {
+            // Past the end: hold the last mouse position and keep the clock running
+            input = sb_last(replay_frames);
+            input.mouse_pressed = false;
+        }
+    } else if(input_source == INPUT_SOURCE_HEADLESS) {
+        input.frame_time = input_fixed_frame_time;
+        input.time = headless_time;
+        headless_time += input_fixed_frame_time;
+    } else {
+        input.frame_time = GetFrameTime();
+        input.time = GetTime();
+        input.mouse_x = GetMouseX();
+        input.mouse_y = GetMouseY();
+        input.mouse_pressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+
+        // raylib saw the press at its last poll; the sampler knows when it was
+        frame_sample_time = SteadySeconds();
+        latch_time = frame_sample_time;
+        click_time = 0.;
+#if defined(_WIN32)
+        OsPoint cursor;
+        if(GetCursorPos(&cursor)) {
+            sample_cursor_x = cursor.x;
+            sample_cursor_y = cursor.y;
+        }
+#endif
+        const double press_time = last_press_time.load(std::memory_order_acquire);
+        if(input.mouse_pressed && press_time > used_press_time && frame_sample_time - press_time <= max_click_lead) {
+            input.click_lead = (float) (frame_sample_time - press_time);
+            click_time = press_time;
+            used_press_time = press_time;
+        }
+    }
+
+    if(record_file != nullptr) {
+        fprintf(record_file, "%.9g %.9g %d %d %d %.9g\n", input.frame_time, input.time,
+                input.mouse_x, input.mouse_y, input.mouse_pressed ? 1 : 0, input.click_lead);
+        record_frame_count++;
+    }
+    return input;
+}
+
+void LatchCursor(int* mouse_x, int* mouse_y) {
+    if(input_source != INPUT_SOURCE_WINDOW) { return; }
+#if defined(_WIN32)
+    OsPoint point;
+    if(GetCursorPos(&point) && ScreenToClient(GetWindowHandle(), &point)) {
+        *mouse_x = (int) point.x;
+        *mouse_y = (int) point.y;
+        latch_time = SteadySeconds();
+    }
+#else
+    (void) mouse_x;
+    (void) mouse_y;
+#endif
+}
+
+bool HasPendingWindowInput() {
+    if(input_source != INPUT_SOURCE_WINDOW) { return false; }
+#if defined(_WIN32)
+    if(last_press_time.load(std::memory_order_acquire) > frame_sample_time) { return true; }
+    OsPoint cursor;
+    return GetCursorPos(&cursor) && (cursor.x != sample_cursor_x || cursor.y != sample_cursor_y);
+#else
+    return false;
+#endif
+}
+
+bool HasWindowLostFocus() {
+    if(input_source != INPUT_SOURCE_WINDOW) { return false; }
+#if defined(_WIN32)
+    return GetForegroundWindow() != GetWindowHandle();
+#else
+    return false;
+#endif
+}
+
+void RecordInputLatency(double submit_time, double scanout_seconds) {
+    const double photon_time = submit_time + scanout_seconds;
+    InputLatencyStats* stats = &latency_stats;
+    const double frame_ms = (photon_time - frame_sample_time) * 1000.;
+    const double latched_ms = (photon_time - latch_time) * 1000.;
+    stats->frames++;
+    stats->frame_seconds += frame_ms / 1000.;
+    if(frame_ms > stats->max_frame_ms) { stats->max_frame_ms = frame_ms; }
+    stats->latched_seconds += latched_ms / 1000.;
+    if(latched_ms > stats->max_latched_ms) { stats->max_latched_ms = latched_ms; }
+    if(click_time > 0.) {
+        const double click_ms = (photon_time - click_time) * 1000.;
+        stats->clicks++;
+        stats->click_seconds += click_ms / 1000.;
+        if(click_ms > stats->max_click_ms) { stats->max_click_ms = click_ms; }
+        click_time = 0.;
+    }
+}
+
+void LogInputLatencyStats() {
+    const InputLatencyStats* stats = &latency_stats;
+    if(stats->frames == 0) { return; }
+    TraceLog(LOG_INFO, "Input latency over %d frames: frame sample %.2f ms avg, %.2f ms max; latched cursor %.2f ms avg, %.2f ms max",
+             stats->frames, stats->frame_seconds * 1000. / stats->frames, stats->max_frame_ms,
+             stats->latched_seconds * 1000. / stats->frames, stats->max_latched_ms);
+    TraceLog(LOG_INFO, "Input latency over %d timed clicks: %.2f ms avg, %.2f ms max", stats->clicks,
+             stats->clicks > 0 ? stats->click_seconds * 1000. / stats->clicks : 0., stats->max_click_ms);
+}
+
+void CloseFrameInput() {
+    StopPressSampler();
+    StopInputRecording();
+    sb_free(replay_frames);
+    replay_frames = nullptr;
+}
+
+unsigned int GetReplaySeed() {
+    return replay_seed;
+}
+
+int GetReplayFrameCount() {
+    return sb_count(replay_frames);
+}
+
+static void WriteSessionHeader() {
+    // Fixed width so it can be rewritten in place once the frame count is known
+    fprintf(record_file, "SESSION %d seed=%010u frames=%010d\n", SESSION_VERSION, record_seed, record_frame_count);
+}
+
+bool StartInputRecording(const char* filename, unsigned int seed) {
+    StopInputRecording();
+    record_file = fopen(filename, "w");
+    if(record_file == nullptr) {
+        TraceLog(LOG_WARNING, "Could not open %s for recording", filename);
+        return false;
+    }
+    record_seed = seed;
+    record_frame_count = 0;
+    record_header_pos = ftell(record_file);
+    WriteSessionHeader();
+    return true;
+}
+
+void StopInputRecording() {
+    if(record_file == nullptr) { return; }
+    fseek(record_file, record_header_pos, SEEK_SET);
+    WriteSessionHeader();
+    fclose(record_file);
+    record_file = nullptr;
+}
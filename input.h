@@ -0,0 +1,74 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+
+// Everything the game reads from the player and the clock in one frame. The
+// window source polls raylib; the headless source advances a fixed-step
+// clock with the mouse parked and no clicks; the replay source plays back a
+// recorded session file.
+//
+// raylib only polls input once a frame, right after the buffer swap, so by
+// the time a frame is drawn its input is most of a frame old. On Windows the
+// window source also asks the OS directly: a sampler thread timestamps left
+// button presses to the millisecond, so a click carries how long ago it
+// really happened, and LatchCursor reads the cursor again just before
+// drawing. Elsewhere clicks have no lead, the latch returns the frame's own
+// sample and there is no way to see input between polls.
+//
+// Session files are plain text: a header line with the format version, the
+// random seed and the frame count, then one line per frame with the frame
+// time, clock time, mouse position, click flag and click lead. Version 1
+// files have no click lead.
+const int INPUT_SOURCE_WINDOW = 0;
+const int INPUT_SOURCE_HEADLESS = 1;
+const int INPUT_SOURCE_REPLAY = 2;
+
+struct FrameInput {
+    float frame_time;           // Seconds since the previous frame
+    double time;                // Seconds since the first frame
+    int mouse_x;
+    int mouse_y;
+    bool mouse_pressed;         // Left button went down this frame
+    float click_lead;           // Seconds from the press to this frame's sample
+};
+
+// Estimated input-to-photon latency: from each sample to the frame reaching
+// the screen, taken as the draw submission plus the scanout time the caller
+// passes in
+struct InputLatencyStats {
+    int frames;
+    double frame_seconds;       // From the top-of-frame sample
+    double max_frame_ms;
+    double latched_seconds;     // From LatchCursor
+    double max_latched_ms;
+    int clicks;                 // Presses with a timestamp
+    double click_seconds;
+    double max_click_ms;
+};
+
+bool InitFrameInput(int source, float fixed_frame_time, const char* replay_filename = nullptr);
+FrameInput NextFrameInput();
+void CloseFrameInput();
+
+// Replay source only
+unsigned int GetReplaySeed();
+int GetReplayFrameCount();
+
+// Window source: the cursor as it is now; other sources leave x and y alone
+void LatchCursor(int* mouse_x, int* mouse_y);
+// Window source: the cursor moved or the button went down since the frame
+// sample, before raylib has polled it
+bool HasPendingWindowInput();
+// Window source: another window is in the foreground (Windows only; raylib
+// 3.0 can't tell, so elsewhere this is always false)
+bool HasWindowLostFocus();
+
+// Call once a frame after drawing; submit_time is on the steady clock
+void RecordInputLatency(double submit_time, double scanout_seconds);
+void LogInputLatencyStats();
+
+// Appends every frame returned by NextFrameInput to a session file
+bool StartInputRecording(const char* filename, unsigned int seed);
+void StopInputRecording();
+
+#endif // INPUT_H
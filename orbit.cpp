@@ -0,0 +1,45 @@
+#include <math.h>
+#include "orbit.h"
+
+
+static double WrapDegrees(double degrees) {
+    double wrapped = fmod(degrees, 360.);
+    return wrapped < 0. ? wrapped + 360. : wrapped;
+}
+
+void InitTimeline(Timeline* timeline) {
+    timeline->sim_time = 0.;
+    timeline->orbit_epoch = 0.;
+    timeline->play_epoch = 0.;
+}
+
+void AdvanceTimeline(Timeline* timeline, float frame_time) {
+    timeline->sim_time += frame_time;
+}
+
+void RestartOrbit(Timeline* timeline) {
+    timeline->orbit_epoch = timeline->sim_time;
+}
+
+void StartPlayClock(Timeline* timeline) {
+    timeline->play_epoch = timeline->sim_time;
+}
+
+float GetSunRotation(const Timeline* timeline) {
+    return (float) WrapDegrees(ORBIT_SUN_ROTATION_DELTA * timeline->sim_time);
+}
+
+float GetEarthAngle(const Timeline* timeline) {
+    double elapsed = timeline->sim_time - timeline->orbit_epoch;
+    return (float) WrapDegrees(ORBIT_EARTH_START_ANGLE - ORBIT_EARTH_REVOLVE_DELTA * elapsed);
+}
+
+Vector2 GetEarthOffset(const Timeline* timeline) {
+    double radians = DEG2RAD * (double) GetEarthAngle(timeline);
+    return (Vector2) { (float) (ORBIT_EARTH_REVOLVE_RADIUS * cos(radians)),
+                       (float) (ORBIT_EARTH_REVOLVE_RADIUS * sin(radians)) };
+}
+
+double GetYearCount(const Timeline* timeline) {
+    return (timeline->sim_time - timeline->play_epoch) / ORBIT_YEAR_SECONDS;
+}
@@ -0,0 +1,34 @@
+#ifndef ORBIT_H
+#define ORBIT_H
+
+#include "raylib.h"
+
+
+// Closed-form model of the solar system. Instead of stepping angles each
+// frame, everything is a function of one simulation clock: the Sun's spin,
+// Earth's place on its orbit, and the years survived in the current game.
+// The clock only runs while the solar system is on screen. Snapshots and
+// rewind seeks jump to any time just by copying a Timeline back.
+const float ORBIT_SUN_ROTATION_DELTA = 15.f;    // Degrees per second
+const float ORBIT_EARTH_REVOLVE_DELTA = 18.f;   // Degrees per second, clockwise
+const float ORBIT_EARTH_REVOLVE_RADIUS = 180.f; // Pixels
+const float ORBIT_EARTH_START_ANGLE = 45.f;     // Degrees
+const double ORBIT_YEAR_SECONDS = 360. / ORBIT_EARTH_REVOLVE_DELTA;
+
+struct Timeline {
+    double sim_time;            // Seconds the solar system has been running
+    double orbit_epoch;         // sim_time when Earth was at its start angle
+    double play_epoch;          // sim_time when the current game started
+};
+
+void InitTimeline(Timeline* timeline);
+void AdvanceTimeline(Timeline* timeline, float frame_time);
+void RestartOrbit(Timeline* timeline);
+void StartPlayClock(Timeline* timeline);
+
+float GetSunRotation(const Timeline* timeline);        // Degrees
+float GetEarthAngle(const Timeline* timeline);         // Degrees in [0, 360)
+Vector2 GetEarthOffset(const Timeline* timeline);      // From the Sun's centre
+double GetYearCount(const Timeline* timeline);
+
+#endif // ORBIT_H
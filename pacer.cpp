@@ -0,0 +1,122 @@
+#include <chrono>
+#include <thread>
+#include <time.h>
+#include "input.h"
+#include "pacer.h"
+#include "raylib.h"
+
+
+#if defined(_WIN32)
+// clock() is wall time on Windows, so ask for the process times directly
+struct OsFileTime {
+    unsigned long low;
+    unsigned long high;
+};
+extern "C" __declspec(dllimport) void* __stdcall GetCurrentProcess();
+extern "C" __declspec(dllimport) int __stdcall GetProcessTimes(void* process, OsFileTime* creation, OsFileTime* exit,
+                                                               OsFileTime* kernel, OsFileTime* user);
+#endif
+
+static const char* PACE_MODE_NAMES[PACE_COUNT] = { "active", "idle", "background" };
+
+static double SteadySeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double ProcessCpuSeconds() {
+#if defined(_WIN32)
+    OsFileTime creation, exit, kernel, user;
+    if(!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) { return 0.; }
+    unsigned long long ticks = ((unsigned long long) kernel.high << 32 | kernel.low) +
+                               ((unsigned long long) user.high << 32 | user.low);
+    return (double) ticks * 1e-7;
+#else
+    return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void SleepUntil(double due) {
+    double delay = due - SteadySeconds();
+    if(delay <= 0.) { return; }
+    std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+}
+
+void InitFramePacer(FramePacer* pacer, const PacerConfig* config) {
+    *pacer = FramePacer();
+    pacer->config = *config;
+    pacer->mode = PACE_ACTIVE;
+    pacer->frame_start = SteadySeconds();
+    pacer->due_time = pacer->frame_start;
+    pacer->cpu_start = ProcessCpuSeconds();
+    pacer->last_input_time = pacer->frame_start;
+}
+
+void PaceFrame(FramePacer* pacer, bool is_static, bool has_input, bool is_background) {
+    const PacerConfig* config = &pacer->config;
+    double now = SteadySeconds();
+    if(has_input) { pacer->last_input_time = now; }
+
+    int mode = PACE_ACTIVE;
+    if(is_background) {
+        mode = PACE_BACKGROUND;
+    } else if(is_static && now - pacer->last_input_time >= config->idle_delay) {
+        mode = PACE_IDLE;
+    }
+    if(mode != pacer->mode) {
+        TraceLog(LOG_INFO, "Pacer: %s -> %s", PACE_MODE_NAMES[pacer->mode], PACE_MODE_NAMES[mode]);
+        pacer->stats.mode_changes++;
+    }
+    pacer->mode = mode;
+
+    int fps = mode == PACE_BACKGROUND ? config->background_fps : mode == PACE_IDLE ? config->idle_fps : config->active_fps;
+    if(!is_static && fps < PACER_MIN_MOVING_FPS) { fps = PACER_MIN_MOVING_FPS; }
+    if(fps > config->active_fps) { fps = config->active_fps; }
+    // Due times follow on from each other so oversleeping doesn't add up,
+    // but a late frame doesn't earn a burst of catch-up frames either
+    double due = fps > 0 ? pacer->due_time + 1. / fps : now;
+    if(due < now) { due = now; }
+    pacer->due_time = due;
+    const double wait_start = now;
+    pacer->work_ms = (float) ((wait_start - pacer->frame_start) * 1000.);
+
+    if(mode == PACE_ACTIVE) {
+        SleepUntil(due);
+    } else {
+        while(now < due) {
+            if(HasPendingWindowInput()) {
+                pacer->stats.early_wakes++;
+                pacer->last_input_time = now;
+                pacer->due_time = now;
+                break;
+            }
+            SleepUntil(now + PACER_WAKE_SLICE < due ? now + PACER_WAKE_SLICE : due);
+            now = SteadySeconds();
+        }
+    }
+
+    const double frame_end = SteadySeconds();
+    const double cpu_end = ProcessCpuSeconds();
+    const double cpu_ms = (cpu_end - pacer->cpu_start) * 1000.;
+    PacerStats* stats = &pacer->stats;
+    stats->frames[mode]++;
+    stats->wall_seconds[mode] += frame_end - pacer->frame_start;
+    stats->cpu_seconds[mode] += cpu_ms / 1000.;
+    if(cpu_ms > stats->max_cpu_ms[mode]) { stats->max_cpu_ms[mode] = cpu_ms; }
+    stats->sleep_seconds += frame_end - wait_start;
+    pacer->frame_start = frame_end;
+    pacer->cpu_start = cpu_end;
+}
+
+void LogFramePacerStats(const FramePacer* pacer) {
+    const PacerStats* stats = &pacer->stats;
+    for(int mode = 0; mode < PACE_COUNT; mode++) {
+        const int frames = stats->frames[mode];
+        if(frames == 0) { continue; }
+        TraceLog(LOG_INFO, "Pacer (%s): %d frames at %.1f fps, CPU %.3f ms avg, %.3f ms max per frame (%.0f%% of a core)",
+                 PACE_MODE_NAMES[mode], frames, stats->wall_seconds[mode] > 0. ? frames / stats->wall_seconds[mode] : 0.,
+                 stats->cpu_seconds[mode] * 1000. / frames, stats->max_cpu_ms[mode],
+                 stats->wall_seconds[mode] > 0. ? stats->cpu_seconds[mode] * 100. / stats->wall_seconds[mode] : 0.);
+    }
+    TraceLog(LOG_INFO, "Pacer: %.2f s asleep, %d mode changes, %d waits cut short by input",
+             stats->sleep_seconds, stats->mode_changes, stats->early_wakes);
+}
@@ -0,0 +1,65 @@
+#ifndef PACER_H
+#define PACER_H
+
+
+// Paces the window loop in place of SetTargetFPS, which only knows one rate.
+// After each frame the pacer picks a rate and sleeps until the next frame is
+// due:
+//
+//   active      full rate, while anything moves or the player is busy
+//   idle        a static screen (title, end choice) with no input for a
+//               while; only the stars and the Sun move there
+//   background  the window is minimised, or on Windows, another window
+//               is in the foreground
+//
+// Input puts it straight back to active. Idle and background waits sleep
+// in short slices and wake early when the OS reports input that raylib
+// has not polled yet (Windows only; elsewhere input is seen at the next
+// frame). Screens with moving sprites never drop below
+// PACER_MIN_MOVING_FPS, since the game steps by the real frame time and
+// long steps would let flares skip past asteroids.
+//
+// CPU time is the whole process's, so the audio and input threads count
+// too, and is reported per frame for each rate.
+const int PACE_ACTIVE = 0;
+const int PACE_IDLE = 1;
+const int PACE_BACKGROUND = 2;
+const int PACE_COUNT = 3;
+
+const int PACER_MIN_MOVING_FPS = 30;
+const float PACER_WAKE_SLICE = 0.004f;     // Seconds between input checks while waiting
+
+struct PacerConfig {
+    int active_fps;
+    int idle_fps;
+    int background_fps;
+    float idle_delay;           // Seconds without input before a static screen idles
+};
+
+struct PacerStats {
+    int frames[PACE_COUNT];
+    double wall_seconds[PACE_COUNT];
+    double cpu_seconds[PACE_COUNT];
+    double max_cpu_ms[PACE_COUNT];
+    double sleep_seconds;
+    int early_wakes;            // Waits cut short by input
+    int mode_changes;
+};
+
+struct FramePacer {
+    PacerConfig config;
+    int mode;
+    double frame_start;         // Steady clock seconds
+    double due_time;            // When the current frame was due to start
+    double cpu_start;           // Process CPU seconds
+    double last_input_time;
+    float work_ms;              // Last frame, from its start to the wait
+    PacerStats stats;
+};
+
+void InitFramePacer(FramePacer* pacer, const PacerConfig* config);
+// Call once a frame after drawing; returns once the next frame is due
+void PaceFrame(FramePacer* pacer, bool is_static, bool has_input, bool is_background);
+void LogFramePacerStats(const FramePacer* pacer);
+
+#endif // PACER_H
@@ -0,0 +1,183 @@
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "particles.h"
+#include "gfx.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PARTICLES_SSE2
+#endif
+
+
+static void GrowParticles(ParticleSystem* particles, int needed) {
+    int capacity = particles->capacity > 0 ? particles->capacity : 1024;
+    while(capacity < needed) { capacity *= 2; }
+    if(capacity == particles->capacity) { return; }
+    particles->x = (float*) realloc(particles->x, sizeof(float) * capacity);
+    particles->y = (float*) realloc(particles->y, sizeof(float) * capacity);
+    particles->vx = (float*) realloc(particles->vx, sizeof(float) * capacity);
+    particles->vy = (float*) realloc(particles->vy, sizeof(float) * capacity);
+    particles->life = (float*) realloc(particles->life, sizeof(float) * capacity);
+    particles->inv_life = (float*) realloc(particles->inv_life, sizeof(float) * capacity);
+    particles->color = (Color*) realloc(particles->color, sizeof(Color) * capacity);
+    // The vector loops run over padding lanes past the count, so keep them finite
+    const int added = capacity - particles->capacity;
+    float* arrays[] = { particles->x, particles->y, particles->vx, particles->vy, particles->life, particles->inv_life };
+    for(int a = 0; a < 6; a++) { memset(arrays[a] + particles->capacity, 0, sizeof(float) * added); }
+    particles->capacity = capacity;
+}
+
+void InitParticles(ParticleSystem* particles, float drag, unsigned int seed) {
+    *particles = ParticleSystem();
+    particles->drag = drag;
+    SeedRandomStream(&particles->rng, seed, RANDOM_STREAM_PARTICLES);
+    GrowParticles(particles, 0);
+}
+
+void EmitParticles(ParticleSystem* particles, const ParticleBurst* burst) {
+    int count = burst->count;
+    if(particles->count + count > PARTICLE_MAX_COUNT) {
+        count = PARTICLE_MAX_COUNT - particles->count;
+        particles->stats.dropped++;
+    }
+    if(count <= 0) { return; }
+    // Round up so the vector loops can always read whole groups of four
+    GrowParticles(particles, (particles->count + count + 3) & ~3);
+
+    const int first = particles->count;
+    for(int i = first; i < first + count; i++) {
+        const float angle = RandomFloat(&particles->rng) * 2.f * PI;
+        const float speed = RandomFloatRange(&particles->rng, burst->min_speed, burst->max_speed);
+        const float life = RandomFloatRange(&particles->rng, burst->min_life, burst->max_life);
+        particles->x[i] = burst->x;
+        particles->y[i] = burst->y;
+        particles->vx[i] = cosf(angle) * speed;
+        particles->vy[i] = sinf(angle) * speed;
+        particles->life[i] = life;
+        particles->inv_life[i] = 1.f / life;
+        particles->color[i] = burst->color;
+    }
+    particles->count += count;
+    particles->stats.emitted += count;
+    if(particles->count > particles->stats.max_live) { particles->stats.max_live = particles->count; }
+}
+
+void ReserveParticles(ParticleSystem* particles, int count) {
+    GrowParticles(particles, (count + 3) & ~3);
+}
+
+void UpdateParticles(ParticleSystem* particles, float frame_time) {
+    auto start = std::chrono::steady_clock::now();
+    const int count = particles->count;
+    const int padded_count = (count + 3) & ~3;
+    const float damping = expf(-particles->drag * frame_time);
+    float* x = particles->x;
+    float* y = particles->y;
+    float* vx = particles->vx;
+    float* vy = particles->vy;
+    float* life = particles->life;
+
+    // Integrate everything, padding included; the padding is never read back
+#ifdef PARTICLES_SSE2
+    const __m128 dt = _mm_set1_ps(frame_time);
+    const __m128 damp = _mm_set1_ps(damping);
+    for(int i = 0; i < padded_count; i += 4) {
+        __m128 pvx = _mm_loadu_ps(vx + i);
+        __m128 pvy = _mm_loadu_ps(vy + i);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(pvx, dt)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(pvy, dt)));
+        _mm_storeu_ps(vx + i, _mm_mul_ps(pvx, damp));
+        _mm_storeu_ps(vy + i, _mm_mul_ps(pvy, damp));
+        _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), dt));
+    }
+#else
+    for(int i = 0; i < padded_count; i++) {
+        x[i] += vx[i] * frame_time;
+        y[i] += vy[i] * frame_time;
+        vx[i] *= damping;
+        vy[i] *= damping;
+        life[i] -= frame_time;
+    }
+#endif
+
+    // Drop expired particles and fade the rest. Runs of four live particles
+    // that have not moved yet skip the copy.
+    int live = 0;
+    int i = 0;
+#ifdef PARTICLES_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    for(; i + 4 <= count; i += 4) {
+        int alive = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(life + i), zero));
+        if(alive == 0) { continue; }
+        if(alive == 0xf && live == i) {
+            for(int lane = 0; lane < 4; lane++) {
+                particles->color[i + lane].a = (unsigned char) (life[i + lane] * particles->inv_life[i + lane] * 255.f);
+            }
+            live += 4;
+            continue;
+        }
+        for(int lane = 0; lane < 4; lane++) {
+            if(!(alive & (1 << lane))) { continue; }
+            const int from = i + lane;
+            x[live] = x[from];
+            y[live] = y[from];
+            vx[live] = vx[from];
+            vy[live] = vy[from];
+            life[live] = life[from];
+            particles->inv_life[live] = particles->inv_life[from];
+            particles->color[live] = particles->color[from];
+            particles->color[live].a = (unsigned char) (life[live] * particles->inv_life[live] * 255.f);
+            live++;
+        }
+    }
+#endif
+    for(; i < count; i++) {
+        if(life[i] <= 0.f) { continue; }
+        x[live] = x[i];
+        y[live] = y[i];
+        vx[live] = vx[i];
+        vy[live] = vy[i];
+        life[live] = life[i];
+        particles->inv_life[live] = particles->inv_life[i];
+        particles->color[live] = particles->color[i];
+        particles->color[live].a = (unsigned char) (life[live] * particles->inv_life[live] * 255.f);
+        live++;
+    }
+    particles->count = live;
+
+    double update_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    particles->stats.updates++;
+    particles->stats.update_seconds += update_ms / 1000.;
+    if(update_ms > particles->stats.max_update_ms) { particles->stats.max_update_ms = update_ms; }
+}
+
+void DrawParticles(const ParticleSystem* particles, float size) {
+    GfxQuadBatch(particles->x, particles->y, particles->color, particles->count, size);
+}
+
+void ClearParticles(ParticleSystem* particles) {
+    particles->count = 0;
+}
+
+void FreeParticles(ParticleSystem* particles) {
+    free(particles->x);
+    free(particles->y);
+    free(particles->vx);
+    free(particles->vy);
+    free(particles->life);
+    free(particles->inv_life);
+    free(particles->color);
+    particles->x = particles->y = particles->vx = particles->vy = nullptr;
+    particles->life = particles->inv_life = nullptr;
+    particles->color = nullptr;
+    particles->count = particles->capacity = 0;
+}
+
+void LogParticleStats(const ParticleSystem* particles) {
+    const ParticleStats* stats = &particles->stats;
+    TraceLog(LOG_INFO, "Particles: %lld emitted (%lld bursts cut short), %d live at most, %d updates in %.2f ms (%.3f ms avg, %.3f ms max)",
+             stats->emitted, stats->dropped, stats->max_live, stats->updates, stats->update_seconds * 1000.,
+             stats->updates > 0 ? stats->update_seconds * 1000. / stats->updates : 0., stats->max_update_ms);
+}
@@ -0,0 +1,63 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "raylib.h"
+#include "random.h"
+
+
+// Purely visual particles: explosion debris and sparks. They never take part
+// in collisions and are kept apart from the game's sprites. Each attribute
+// lives in its own array, so integration and lifetime run four particles at
+// a time, and a burst from one emitter lands in one contiguous run. Expired
+// particles are compacted out in the same pass, keeping the live ones packed
+// at the front, and the whole set is drawn as one batch of solid quads.
+const int PARTICLE_MAX_COUNT = 262144;
+
+struct ParticleBurst {
+    float x;
+    float y;
+    int count;
+    float min_speed;            // Pixels per second
+    float max_speed;
+    float min_life;             // Seconds
+    float max_life;
+    Color color;
+};
+
+struct ParticleStats {
+    long long emitted;
+    long long dropped;          // Bursts past PARTICLE_MAX_COUNT
+    int max_live;
+    int updates;
+    double update_seconds;
+    double max_update_ms;
+};
+
+struct ParticleSystem {
+    int count;
+    int capacity;               // Always a multiple of 4
+    float drag;                 // Fraction of speed lost per second
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* life;                // Seconds left
+    float* inv_life;            // 1 / starting life, for the fade
+    Color* color;               // Alpha follows the life left
+    RandomStream rng;
+    ParticleStats stats;
+};
+
+void InitParticles(ParticleSystem* particles, float drag, unsigned int seed);
+void EmitParticles(ParticleSystem* particles, const ParticleBurst* burst);
+// Makes room for count particles without emitting any; for restoring state
+void ReserveParticles(ParticleSystem* particles, int count);
+void UpdateParticles(ParticleSystem* particles, float frame_time);
+// Draws in whatever space is active, so call inside GfxBeginCamera for world particles
+void DrawParticles(const ParticleSystem* particles, float size);
+void ClearParticles(ParticleSystem* particles);
+void FreeParticles(ParticleSystem* particles);
+
+void LogParticleStats(const ParticleSystem* particles);
+
+#endif // PARTICLES_H
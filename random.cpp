@@ -0,0 +1,88 @@
+#include "random.h"
+
+
+static inline uint32_t RotateLeft(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint64_t SplitMix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static inline float ToUnitFloat(uint32_t x) {
+    // Top 24 bits, so every value is exactly representable and below 1
+    return (float) (x >> 8) * (1.f / 16777216.f);
+}
+
+void SeedRandomStream(RandomStream* stream, unsigned int seed, unsigned int stream_id) {
+    uint64_t state = ((uint64_t) seed << 32) | stream_id;
+    for(int i = 0; i < 4; i += 2) {
+        uint64_t z = SplitMix64(&state);
+        stream->s[i] = (uint32_t) z;
+        stream->s[i + 1] = (uint32_t) (z >> 32);
+    }
+    // An all-zero state never leaves zero
+    if((stream->s[0] | stream->s[1] | stream->s[2] | stream->s[3]) == 0) {
+        stream->s[0] = 0x9e3779b9u;
+    }
+}
+
+uint32_t NextRandom(RandomStream* stream) {
+    uint32_t* s = stream->s;
+    const uint32_t result = RotateLeft(s[1] * 5, 7) * 9;
+    const uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft(s[3], 11);
+    return result;
+}
+
+int RandomInt(RandomStream* stream, int min, int max) {
+    if(min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    const uint32_t range = (uint32_t) ((int64_t) max - min) + 1u;
+    if(range == 0) { return (int) NextRandom(stream); }  // Full 32-bit range
+
+    // Lemire's multiply-and-reject, unbiased without a division in the common case
+    uint64_t m = (uint64_t) NextRandom(stream) * range;
+    uint32_t low = (uint32_t) m;
+    if(low < range) {
+        const uint32_t threshold = (0u - range) % range;
+        while(low < threshold) {
+            m = (uint64_t) NextRandom(stream) * range;
+            low = (uint32_t) m;
+        }
+    }
+    return (int) ((int64_t) min + (int64_t) (m >> 32));
+}
+
+float RandomFloat(RandomStream* stream) {
+    return ToUnitFloat(NextRandom(stream));
+}
+
+float RandomFloatRange(RandomStream* stream, float min, float max) {
+    if(min > max) {
+        float tmp = max;
+        max = min;
+        min = tmp;
+    }
+    return min + (max - min) * RandomFloat(stream);
+}
+
+void RandomFloats(RandomStream* stream, float* out, int count) {
+    // Work on a local copy of the state so it stays in registers
+    RandomStream local = *stream;
+    for(int i = 0; i < count; i++) {
+        out[i] = ToUnitFloat(NextRandom(&local));
+    }
+    *stream = local;
+}
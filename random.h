@@ -0,0 +1,32 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+
+// Small deterministic PRNG (xoshiro128**). Each subsystem owns its own
+// stream, seeded from the run seed and a stream id, so adding random calls
+// in one place never shifts the sequence seen by another. Streams are plain
+// values and can be copied to save and restore their state.
+const unsigned int RANDOM_STREAM_SPAWN = 1;
+const unsigned int RANDOM_STREAM_EFFECTS = 2;
+const unsigned int RANDOM_STREAM_STARS = 3;
+const unsigned int RANDOM_STREAM_PARTICLES = 4;
+const unsigned int RANDOM_STREAM_BOT = 5;
+
+struct RandomStream {
+    uint32_t s[4];
+};
+
+void SeedRandomStream(RandomStream* stream, unsigned int seed, unsigned int stream_id);
+uint32_t NextRandom(RandomStream* stream);
+
+// Inclusive on both ends, like GetRandomValue; swapped bounds are accepted
+int RandomInt(RandomStream* stream, int min, int max);
+// Uniform in [0, 1)
+float RandomFloat(RandomStream* stream);
+float RandomFloatRange(RandomStream* stream, float min, float max);
+// Fills out with count uniform floats in [0, 1)
+void RandomFloats(RandomStream* stream, float* out, int count);
+
+#endif // RANDOM_H
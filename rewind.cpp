@@ -0,0 +1,361 @@
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rewind.h"
+#include "sbutil.h"
+#include "stretchy_buffer.h"
+
+
+static const int SPRITE_WORDS = sizeof(Sprite) / sizeof(uint32_t);
+static const int CORE_WORDS = sizeof(SnapshotCore) / sizeof(uint32_t);
+
+struct DeltaHeader {
+    float frame_time;
+    int is_moving;              // The step moved sprites and stars
+    int sprite_count;
+    int changed_sprites;
+    int spawn_event_count;
+};
+
+// Same motion as the game's sprite and star updates. Encoder and decoder
+// both use this copy, so a delta always decodes exactly; when the game
+// moves things differently the fields just land in the delta.
+static inline void PredictSprite(Sprite* sprite, float frame_time) {
+    if(sprite->type < 0) { return; }
+    sprite->dest_rect.x += sprite->velocity.x * frame_time;
+    sprite->dest_rect.y += sprite->velocity.y * frame_time;
+    sprite->rotation += sprite->rotation_delta * frame_time;
+    if(sprite->rotation < 0.f) { sprite->rotation += 360.f; }
+    if(sprite->rotation > 360.f) { sprite->rotation -= 360.f; }
+}
+
+// Word diff in blocks of 32: a mask of changed words, then those words
+static unsigned char* EncodeWords(unsigned char* out, const uint32_t* predicted, const uint32_t* current, int count) {
+    for(int block = 0; block < count; block += 32) {
+        const int end = block + 32 < count ? block + 32 : count;
+        uint32_t mask = 0;
+        for(int i = block; i < end; i++) {
+            if(predicted[i] != current[i]) { mask |= 1u << (i - block); }
+        }
+        memcpy(out, &mask, sizeof(mask));
+        out += sizeof(mask);
+        for(int i = block; i < end; i++) {
+            if(!(mask & (1u << (i - block)))) { continue; }
+            memcpy(out, &current[i], sizeof(uint32_t));
+            out += sizeof(uint32_t);
+        }
+    }
+    return out;
+}
+
+static const unsigned char* DecodeWords(const unsigned char* in, uint32_t* words, int count) {
+    for(int block = 0; block < count; block += 32) {
+        uint32_t mask;
+        memcpy(&mask, in, sizeof(mask));
+        in += sizeof(mask);
+        for(int bit = 0; mask != 0; bit++, mask >>= 1) {
+            if(!(mask & 1u)) { continue; }
+            memcpy(&words[block + bit], in, sizeof(uint32_t));
+            in += sizeof(uint32_t);
+        }
+    }
+    return in;
+}
+
+static inline RewindFrame* GetFrame(RewindBuffer* rewind, int n) {
+    return &rewind->frames[(rewind->first_frame + n) % rewind->frame_capacity];
+}
+
+static void DropOldestFrame(RewindBuffer* rewind) {
+    rewind->first_frame = (rewind->first_frame + 1) % rewind->frame_capacity;
+    rewind->frame_count--;
+    // Deltas are useless without the keyframe before them
+    while(rewind->frame_count > 0 && !GetFrame(rewind, 0)->is_keyframe) {
+        rewind->first_frame = (rewind->first_frame + 1) % rewind->frame_capacity;
+        rewind->frame_count--;
+    }
+    if(rewind->frame_count == 0) { rewind->write_offset = 0; }
+}
+
+static bool AppendFrame(RewindBuffer* rewind, const unsigned char* data, int size, int frame_index, bool is_keyframe) {
+    if(size > rewind->byte_capacity) { return false; }
+    if(rewind->frame_count == rewind->frame_capacity) { DropOldestFrame(rewind); }
+
+    int offset = rewind->write_offset;
+    const bool is_wrapped = offset + size > rewind->byte_capacity;
+    if(is_wrapped) { offset = 0; }
+    // The oldest frames sit just past the write offset; drop the ones in the
+    // way, plus the unused tail when the write wraps round
+    while(rewind->frame_count > 0) {
+        const RewindFrame* oldest = GetFrame(rewind, 0);
+        const bool is_in_tail = is_wrapped && oldest->offset >= rewind->write_offset;
+        const bool overlaps = oldest->offset < offset + size && offset < oldest->offset + oldest->size;
+        if(!is_in_tail && !overlaps) { break; }
+        DropOldestFrame(rewind);
+    }
+    if(!is_keyframe && rewind->frame_count == 0) { return false; }
+
+    memcpy(rewind->bytes + offset, data, size);
+    RewindFrame* frame = &rewind->frames[(rewind->first_frame + rewind->frame_count) % rewind->frame_capacity];
+    *frame = { .frame_index = frame_index, .offset = offset, .size = size, .is_keyframe = is_keyframe };
+    rewind->frame_count++;
+    rewind->write_offset = offset + size;
+    return true;
+}
+
+// Copies the game into the encoder's last-seen state
+static void RememberGame(RewindBuffer* rewind, const Game* game) {
+    CaptureSnapshotCore(game, &rewind->last_core);
+    const int sprite_count = sb_count(game->sprites);
+    sb_clear(rewind->last_sprites);
+    sb_add(rewind->last_sprites, sprite_count);
+    memcpy(rewind->last_sprites, game->sprites, sprite_count * sizeof(Sprite));
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        const StarLayer* layer = &game->star_field.layers[l];
+        for(int axis = 0; axis < 2; axis++) {
+            rewind->last_stars[l][axis] = (float*) realloc(rewind->last_stars[l][axis], sizeof(float) * (layer->padded_count > 0 ? layer->padded_count : 1));
+            memcpy(rewind->last_stars[l][axis], axis == 0 ? layer->x : layer->y, sizeof(float) * layer->padded_count);
+        }
+    }
+    rewind->has_last = true;
+}
+
+// Also moves the encoder's last-seen state up to the game, in the same pass
+static int EncodeDelta(RewindBuffer* rewind, const Game* game, float frame_time) {
+    const int sprite_count = sb_count(game->sprites);
+    const int spawn_event_count = sb_count(game->spawner.queue);
+    int star_words = 0;
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) { star_words += 2 * game->star_field.layers[l].padded_count; }
+    // Worst case: every word changed, plus the masks
+    const int needed = sizeof(DeltaHeader) + 2 * sizeof(SnapshotCore) +
+                       sprite_count * (sizeof(int) + 2 * sizeof(Sprite)) +
+                       2 * star_words * sizeof(float) + 64 +
+                       spawn_event_count * sizeof(SpawnEvent);
+    if(rewind->delta_capacity < needed) {
+        rewind->delta = (unsigned char*) realloc(rewind->delta, needed);
+        rewind->delta_capacity = needed;
+    }
+
+    DeltaHeader header = {
+        .frame_time = frame_time,
+        .is_moving = rewind->last_core.state <= STATE_PLAYING,
+        .sprite_count = sprite_count,
+        .changed_sprites = 0,
+        .spawn_event_count = spawn_event_count
+    };
+    unsigned char* out = rewind->delta + sizeof(header);
+
+    SnapshotCore core;
+    CaptureSnapshotCore(game, &core);
+    out = EncodeWords(out, (const uint32_t*) &rewind->last_core, (const uint32_t*) &core, CORE_WORDS);
+    rewind->last_core = core;
+
+    // Sprites added on the end start from the last old one, which is
+    // usually of the same kind
+    const int last_count = sb_count(rewind->last_sprites);
+    const Sprite base = last_count == 0 ? Sprite() : rewind->last_sprites[last_count - 1];
+    if(sprite_count > last_count) { sb_add(rewind->last_sprites, sprite_count - last_count); }
+    for(int i = 0; i < sprite_count; i++) {
+        Sprite predicted = i < last_count ? rewind->last_sprites[i] : base;
+        if(header.is_moving) { PredictSprite(&predicted, frame_time); }
+        rewind->last_sprites[i] = game->sprites[i];
+        if(memcmp(&predicted, &game->sprites[i], sizeof(Sprite)) == 0) { continue; }
+        memcpy(out, &i, sizeof(i));
+        out = EncodeWords(out + sizeof(i), (const uint32_t*) &predicted, (const uint32_t*) &game->sprites[i], SPRITE_WORDS);
+        header.changed_sprites++;
+    }
+
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        const StarLayer* layer = &game->star_field.layers[l];
+        float* predicted_x = rewind->last_stars[l][0];
+        if(header.is_moving) {
+            for(int i = 0; i < layer->padded_count; i++) { predicted_x[i] -= layer->speed; }
+        }
+        out = EncodeWords(out, (const uint32_t*) predicted_x, (const uint32_t*) layer->x, layer->padded_count);
+        out = EncodeWords(out, (const uint32_t*) rewind->last_stars[l][1], (const uint32_t*) layer->y, layer->padded_count);
+        memcpy(rewind->last_stars[l][0], layer->x, sizeof(float) * layer->padded_count);
+        memcpy(rewind->last_stars[l][1], layer->y, sizeof(float) * layer->padded_count);
+    }
+
+    memcpy(out, game->spawner.queue, spawn_event_count * sizeof(SpawnEvent));
+    out += spawn_event_count * sizeof(SpawnEvent);
+    memcpy(rewind->delta, &header, sizeof(header));
+    return (int) (out - rewind->delta);
+}
+
+static void DecodeDelta(Game* game, SnapshotCore* core, const unsigned char* in) {
+    DeltaHeader header;
+    memcpy(&header, in, sizeof(header));
+    in += sizeof(header);
+    in = DecodeWords(in, (uint32_t*) core, CORE_WORDS);
+
+    const int last_count = sb_count(game->sprites);
+    if(header.is_moving) {
+        for(int i = 0; i < last_count; i++) { PredictSprite(&game->sprites[i], header.frame_time); }
+    }
+    if(header.sprite_count > last_count) {
+        const Sprite base = last_count == 0 ? Sprite() : game->sprites[last_count - 1];
+        Sprite* added = sb_add(game->sprites, header.sprite_count - last_count);
+        for(int i = 0; i < header.sprite_count - last_count; i++) { added[i] = base; }
+    }
+    for(int n = 0; n < header.changed_sprites; n++) {
+        int i;
+        memcpy(&i, in, sizeof(i));
+        in = DecodeWords(in + sizeof(i), (uint32_t*) &game->sprites[i], SPRITE_WORDS);
+    }
+
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        StarLayer* layer = &game->star_field.layers[l];
+        if(header.is_moving) {
+            for(int i = 0; i < layer->padded_count; i++) { layer->x[i] -= layer->speed; }
+        }
+        in = DecodeWords(in, (uint32_t*) layer->x, layer->padded_count);
+        in = DecodeWords(in, (uint32_t*) layer->y, layer->padded_count);
+    }
+
+    sb_clear(game->spawner.queue);
+    sb_add(game->spawner.queue, header.spawn_event_count);
+    memcpy(game->spawner.queue, in, header.spawn_event_count * sizeof(SpawnEvent));
+}
+
+// Live sprites carry their expiry, which is all the wheel needs
+static void RebuildLifetimes(Game* game, long long current_tick) {
+    TimerEntry* entries = nullptr;
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        const Sprite* spr = &game->sprites[i];
+        if(spr->type < 0 || spr->lifetime_serial == 0) { continue; }
+        long long due_tick = (long long) ceil(spr->expiry_time / game->lifetimes.tick_seconds);
+        sb_push(entries, ((TimerEntry) { .due_tick = due_tick, .id = i, .serial = spr->lifetime_serial }));
+    }
+    LoadPendingTimers(&game->lifetimes, current_tick, entries, sb_count(entries));
+    sb_free(entries);
+}
+
+void InitRewindBuffer(RewindBuffer* rewind, int max_frames, int max_bytes) {
+    *rewind = RewindBuffer();
+    rewind->frame_capacity = max_frames > 1 ? max_frames : 1;
+    rewind->frames = (RewindFrame*) malloc(sizeof(RewindFrame) * rewind->frame_capacity);
+    rewind->byte_capacity = max_bytes;
+    rewind->bytes = (unsigned char*) malloc(max_bytes);
+}
+
+void FreeRewindBuffer(RewindBuffer* rewind) {
+    free(rewind->bytes);
+    free(rewind->frames);
+    sb_free(rewind->last_sprites);
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        free(rewind->last_stars[l][0]);
+        free(rewind->last_stars[l][1]);
+    }
+    FreeGameSnapshot(&rewind->keyframe);
+    free(rewind->delta);
+    *rewind = RewindBuffer();
+}
+
+void RecordRewindFrame(RewindBuffer* rewind, const Game* game, float frame_time) {
+    auto start = std::chrono::steady_clock::now();
+    // Seeks only work on an unbroken run of frames; a jump starts over
+    if(rewind->frame_count > 0 && game->frame_index != GetRewindLastFrame(rewind) + 1) {
+        rewind->frame_count = 0;
+        rewind->write_offset = 0;
+        rewind->has_last = false;
+    }
+    // A restored game can have fewer sprites than last seen; start afresh
+    const bool needs_keyframe = !rewind->has_last || rewind->frame_count == 0 ||
+                                rewind->frames_since_keyframe + 1 >= REWIND_KEYFRAME_INTERVAL ||
+                                sb_count(game->sprites) < sb_count(rewind->last_sprites);
+    bool is_recorded;
+    if(needs_keyframe) {
+        CaptureGameSnapshot(game, &rewind->keyframe, false);
+        is_recorded = AppendFrame(rewind, rewind->keyframe.data, rewind->keyframe.size, game->frame_index, true);
+        if(is_recorded) {
+            rewind->frames_since_keyframe = 0;
+            rewind->stats.keyframes++;
+        } else {
+            rewind->stats.dropped++;
+        }
+    } else {
+        int size = EncodeDelta(rewind, game, frame_time);
+        is_recorded = AppendFrame(rewind, rewind->delta, size, game->frame_index, false);
+        rewind->frames_since_keyframe++;
+        rewind->stats.delta_bytes += size;
+        if(size > rewind->stats.max_delta_bytes) { rewind->stats.max_delta_bytes = size; }
+    }
+    if(!is_recorded) {
+        rewind->has_last = false;
+    } else if(needs_keyframe) {
+        RememberGame(rewind, game);
+    }
+
+    double record_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    rewind->stats.recorded++;
+    rewind->stats.record_seconds += record_ms / 1000.;
+    if(record_ms > rewind->stats.max_record_ms) { rewind->stats.max_record_ms = record_ms; }
+}
+
+int GetRewindFirstFrame(const RewindBuffer* rewind) {
+    return rewind->frame_count > 0 ? rewind->frames[rewind->first_frame].frame_index : -1;
+}
+
+int GetRewindLastFrame(const RewindBuffer* rewind) {
+    if(rewind->frame_count == 0) { return -1; }
+    return rewind->frames[(rewind->first_frame + rewind->frame_count - 1) % rewind->frame_capacity].frame_index;
+}
+
+bool SeekRewindFrame(RewindBuffer* rewind, Game* game, int frame_index) {
+    const int first = GetRewindFirstFrame(rewind);
+    if(rewind->frame_count == 0 || frame_index < first || frame_index > GetRewindLastFrame(rewind)) { return false; }
+    const int target = frame_index - first;     // Frames are recorded one per step
+    int keyframe = target;
+    while(!GetFrame(rewind, keyframe)->is_keyframe) { keyframe--; }
+
+    const RewindFrame* key = GetFrame(rewind, keyframe);
+    GameSnapshot view = { .data = rewind->bytes + key->offset, .size = key->size, .capacity = 0 };
+    if(!RestoreGameSnapshot(game, &view)) { return false; }
+    SnapshotCore core;
+    CaptureSnapshotCore(game, &core);
+    for(int n = keyframe + 1; n <= target; n++) {
+        DecodeDelta(game, &core, rewind->bytes + GetFrame(rewind, n)->offset);
+    }
+    ApplySnapshotCore(game, &core);
+    for(int i = 0; i < sb_count(game->sprites); i++) {
+        Sprite* spr = &game->sprites[i];
+        spr->texture = game->assets->textures[spr->type < 0 ? -spr->type : spr->type];
+    }
+    RebuildLifetimes(game, core.lifetime_tick);
+    ClearParticles(&game->debris);
+    return true;
+}
+
+void TruncateRewind(RewindBuffer* rewind, const Game* game) {
+    while(rewind->frame_count > 0 && GetRewindLastFrame(rewind) > game->frame_index) {
+        rewind->frame_count--;
+    }
+    if(rewind->frame_count == 0) {
+        rewind->write_offset = 0;
+        rewind->has_last = false;
+        return;
+    }
+    const RewindFrame* last = GetFrame(rewind, rewind->frame_count - 1);
+    rewind->write_offset = last->offset + last->size;
+    rewind->frames_since_keyframe = 0;
+    for(int n = rewind->frame_count - 1; n >= 0 && !GetFrame(rewind, n)->is_keyframe; n--) {
+        rewind->frames_since_keyframe++;
+    }
+    RememberGame(rewind, game);
+}
+
+void LogRewindStats(const RewindBuffer* rewind) {
+    const RewindStats* stats = &rewind->stats;
+    const long long deltas = stats->recorded - stats->keyframes - stats->dropped;
+    long long held_bytes = 0;
+    for(int n = 0; n < rewind->frame_count; n++) { held_bytes += rewind->frames[(rewind->first_frame + n) % rewind->frame_capacity].size; }
+    TraceLog(LOG_INFO, "Rewind: %d frames held (%d to %d) in %lld of %d KB, %lld keyframes, deltas %.0f bytes avg, %d max",
+             rewind->frame_count, GetRewindFirstFrame(rewind), GetRewindLastFrame(rewind), held_bytes / 1024, rewind->byte_capacity / 1024,
+             stats->keyframes, deltas > 0 ? (double) stats->delta_bytes / deltas : 0., stats->max_delta_bytes);
+    TraceLog(LOG_INFO, "Rewind: %lld frames recorded in %.2f ms (%.3f ms avg, %.3f ms max), %d keyframes too big to keep",
+             stats->recorded, stats->record_seconds * 1000.,
+             stats->recorded > 0 ? stats->record_seconds * 1000. / stats->recorded : 0., stats->max_record_ms, stats->dropped);
+}
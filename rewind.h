@@ -0,0 +1,80 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "game.h"
+#include "snapshot.h"
+
+
+// History of the last few seconds of play, for stepping back through a
+// session. Every REWIND_KEYFRAME_INTERVAL frames a full snapshot is kept;
+// the frames in between store only what the step changed. Sprites and stars
+// are first moved the way an ordinary step moves them, so a delta only
+// holds the fields that step did not predict: spawns, deaths, hits and
+// fades.
+//
+// Records live in one byte ring of fixed size, with a fixed number of
+// frames. When either runs out, the oldest keyframe and its deltas are
+// dropped together, so memory never grows past what InitRewindBuffer was
+// given.
+//
+// Seeking restores the nearest keyframe and replays deltas up to the
+// frame. Lifetime timers are rebuilt from the sprites. Debris is only for
+// show, so it is not recorded and a seek clears it.
+const int REWIND_KEYFRAME_INTERVAL = 60;
+
+struct RewindFrame {
+    int frame_index;            // Game frame_index after the step
+    int offset;                 // Into the byte ring
+    int size;
+    bool is_keyframe;
+};
+
+struct RewindStats {
+    long long recorded;
+    long long keyframes;
+    long long delta_bytes;
+    int max_delta_bytes;
+    int dropped;                // Keyframes too big for the whole ring
+    double record_seconds;
+    double max_record_ms;
+};
+
+struct RewindBuffer {
+    unsigned char* bytes;
+    int byte_capacity;
+    int write_offset;
+    RewindFrame* frames;        // Ring of frame_capacity records
+    int frame_capacity;
+    int first_frame;
+    int frame_count;
+
+    // The game as of the last record, which the next delta is taken against
+    bool has_last;
+    SnapshotCore last_core;
+    Sprite* last_sprites;       // stretchy_buffer
+    float* last_stars[STARFIELD_LAYER_COUNT][2];
+    int frames_since_keyframe;
+
+    GameSnapshot keyframe;      // Scratch for captures
+    unsigned char* delta;
+    int delta_capacity;
+    RewindStats stats;
+};
+
+void InitRewindBuffer(RewindBuffer* rewind, int max_frames, int max_bytes);
+void FreeRewindBuffer(RewindBuffer* rewind);
+
+// Call once after each UpdateGame
+void RecordRewindFrame(RewindBuffer* rewind, const Game* game, float frame_time);
+
+int GetRewindFirstFrame(const RewindBuffer* rewind);
+int GetRewindLastFrame(const RewindBuffer* rewind);
+// Puts the game back to how it was right after the given frame
+bool SeekRewindFrame(RewindBuffer* rewind, Game* game, int frame_index);
+// Forgets every frame after the one the game is on, so play can carry on
+// from a seek
+void TruncateRewind(RewindBuffer* rewind, const Game* game);
+
+void LogRewindStats(const RewindBuffer* rewind);
+
+#endif // REWIND_H
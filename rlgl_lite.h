@@ -0,0 +1,27 @@
+#ifndef RLGL_LITE_H
+#define RLGL_LITE_H
+
+// The few rlgl entry points needed to push many primitives through raylib's
+// internal batch in one go. raylib.dll exports them, but the prebuilt release
+// only ships raylib.h, so they are declared here (raylib 3.0 signatures).
+#define RL_LINES        0x0001
+#define RL_TRIANGLES    0x0004
+#define RL_QUADS        0x0007
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+void rlBegin(int mode);
+void rlEnd(void);
+void rlVertex2f(float x, float y);
+void rlTexCoord2f(float x, float y);
+void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+void rlEnableTexture(unsigned int id);
+void rlDisableTexture(void);
+bool rlCheckBufferLimit(int vCount);
+void rlglDraw(void);
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // RLGL_LITE_H
@@ -0,0 +1,13 @@
+#ifndef SBUTIL_H
+#define SBUTIL_H
+
+#include "stretchy_buffer.h"
+
+
+// Count helpers that stretchy_buffer.h leaves out. Both keep the allocation,
+// so a cleared buffer fills up again without growing. Null buffers are left
+// alone, and sb_setcount only shrinks: count must not pass sb_count.
+#define sb_setcount(a, count)   ((a) != nullptr ? (void) (stb__sbn(a) = (count)) : (void) 0)
+#define sb_clear(a)             sb_setcount(a, 0)
+
+#endif // SBUTIL_H
@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "sbutil.h"
+#include "stretchy_buffer.h"
+
+
+static const char SNAPSHOT_MAGIC[4] = { 'S', 'C', 'S', 'N' };
+
+struct SnapshotHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int size;          // Whole blob, header included
+    unsigned int core_size;     // sizeof checks against other builds
+    unsigned int sprite_size;
+    unsigned int timer_size;
+    int sprite_count;
+    int timer_count;
+    int spawn_rule_count;
+    int spawn_event_count;
+    int star_counts[STARFIELD_LAYER_COUNT];     // Padded counts
+    int particle_count;
+};
+
+
+struct BlobWriter {
+    unsigned char* data;
+    int offset;
+};
+
+struct BlobReader {
+    const unsigned char* data;
+    int offset;
+    int size;
+};
+
+static inline void Write(BlobWriter* writer, const void* src, int size) {
+    if(size <= 0) { return; }
+    memcpy(writer->data + writer->offset, src, size);
+    writer->offset += size;
+}
+
+static inline bool Read(BlobReader* reader, void* dst, int size) {
+    if(size < 0 || reader->offset + size > reader->size) { return false; }
+    if(size > 0) { memcpy(dst, reader->data + reader->offset, size); }
+    reader->offset += size;
+    return true;
+}
+
+// Blob size the header's counts call for; 64-bit so crafted counts can't wrap
+static long long GetSnapshotSize(const SnapshotHeader* header) {
+    long long star_bytes = 0;
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) { star_bytes += 2LL * header->star_counts[l] * (long long) sizeof(float); }
+    return (long long) sizeof(SnapshotHeader) + (long long) sizeof(SnapshotCore) +
+           header->sprite_count * (long long) sizeof(Sprite) +
+           header->timer_count * (long long) sizeof(TimerEntry) +
+           header->spawn_rule_count * (long long) sizeof(SpawnRule) +
+           header->spawn_event_count * (long long) sizeof(SpawnEvent) +
+           star_bytes +
+           header->particle_count * (long long) (6 * sizeof(float) + sizeof(Color));
+}
+
+// Textures are renderer handles, so they are looked up again from the types
+static inline void RelinkTexture(const Game* game, Sprite* sprite) {
+    int type = sprite->type < 0 ? -sprite->type : sprite->type;
+    sprite->texture = game->assets->textures[type];
+}
+
+void CaptureSnapshotCore(const Game* game, SnapshotCore* core) {
+    memset(core, 0, sizeof(*core));
+    core->state = game->state;
+    core->frame_index = game->frame_index;
+    core->world_w = game->world_w;
+    core->world_h = game->world_h;
+    core->sun_sprite = game->sun_sprite;
+    core->earth_sprite = game->earth_sprite;
+    core->spawn_random = game->spawn_random;
+    core->effects_random = game->effects_random;
+    core->star_random = game->star_field.rng;
+    core->particle_random = game->debris.rng;
+    core->timeline = game->timeline;
+    core->earth_pos = game->earth_pos;
+    core->earth_radius = game->earth_radius;
+    core->lifetime_tick = game->lifetimes.current_tick;
+    core->next_lifetime_serial = game->next_lifetime_serial;
+    core->mouse_init_x = game->mouse_init_x;
+    core->mouse_init_y = game->mouse_init_y;
+    core->mouse_has_moved = game->mouse_has_moved;
+    core->mouse_target_x = game->mouse_target_x;
+    core->mouse_target_y = game->mouse_target_y;
+    core->title_fade_alpha = game->title_fade_alpha;
+    core->earth_revolve_count = game->earth_revolve_count;
+    core->max_earth_revolve_count = game->max_earth_revolve_count;
+    core->asteroids_destroyed = game->asteroids_destroyed;
+    core->flares_fired = game->flares_fired;
+    core->is_earth_killed_by_flare = game->is_earth_killed_by_flare;
+    core->end_zoom_earth_target_x = game->end_zoom_earth_target_x;
+    core->end_zoom_earth_target_y = game->end_zoom_earth_target_y;
+    core->end_fade_alpha = game->end_fade_alpha;
+}
+
+void ApplySnapshotCore(Game* game, const SnapshotCore* core) {
+    game->state = core->state;
+    game->frame_index = core->frame_index;
+    game->sun_sprite = core->sun_sprite;
+    game->earth_sprite = core->earth_sprite;
+    RelinkTexture(game, &game->sun_sprite);
+    game->earth_sprite.texture = game->assets->textures[game->state >= STATE_END_ZOOM ? TEXTURE_IDX_SCORCHED : TEXTURE_IDX_EARTH];
+    game->spawn_random = core->spawn_random;
+    game->effects_random = core->effects_random;
+    game->star_field.rng = core->star_random;
+    game->debris.rng = core->particle_random;
+    game->timeline = core->timeline;
+    game->earth_pos = core->earth_pos;
+    game->earth_radius = core->earth_radius;
+    game->next_lifetime_serial = core->next_lifetime_serial;
+    game->mouse_init_x = core->mouse_init_x;
+    game->mouse_init_y = core->mouse_init_y;
+    game->mouse_has_moved = core->mouse_has_moved != 0;
+    game->mouse_target_x = core->mouse_target_x;
+    game->mouse_target_y = core->mouse_target_y;
+    game->has_latched_aim = false;
+    game->title_fade_alpha = core->title_fade_alpha;
+    game->earth_revolve_count = core->earth_revolve_count;
+    game->max_earth_revolve_count = core->max_earth_revolve_count;
+    game->asteroids_destroyed = core->asteroids_destroyed;
+    game->flares_fired = core->flares_fired;
+    game->is_earth_killed_by_flare = core->is_earth_killed_by_flare != 0;
+    game->end_message = game->is_earth_killed_by_flare ? "You killed the Earth after just %.1f years"
+                                                       : "You kept Earth alive for %.1f years";
+    game->end_zoom_earth_target_x = core->end_zoom_earth_target_x;
+    game->end_zoom_earth_target_y = core->end_zoom_earth_target_y;
+    game->end_fade_alpha = core->end_fade_alpha;
+}
+
+void CaptureGameSnapshot(const Game* game, GameSnapshot* snapshot, bool has_debris) {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.core_size = sizeof(SnapshotCore);
+    header.sprite_size = sizeof(Sprite);
+    header.timer_size = sizeof(TimerEntry);
+    header.sprite_count = sb_count(game->sprites);
+    header.timer_count = game->lifetimes.pending;
+    header.spawn_rule_count = sb_count(game->spawner.rules);
+    header.spawn_event_count = sb_count(game->spawner.queue);
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        header.star_counts[l] = game->star_field.layers[l].padded_count;
+    }
+    header.particle_count = has_debris ? game->debris.count : 0;
+
+    const ParticleSystem* debris = &game->debris;
+    const int size = (int) GetSnapshotSize(&header);
+    header.size = size;
+    if(snapshot->capacity < size) {
+        snapshot->data = (unsigned char*) realloc(snapshot->data, size);
+        snapshot->capacity = size;
+    }
+    snapshot->size = size;
+
+    SnapshotCore core;
+    CaptureSnapshotCore(game, &core);
+
+    BlobWriter writer = { snapshot->data, 0 };
+    Write(&writer, &header, sizeof(header));
+    Write(&writer, &core, sizeof(core));
+    Write(&writer, game->sprites, header.sprite_count * sizeof(Sprite));
+    // Header, core and sprites are all multiples of 8 bytes, so the timers
+    // are copied straight in and out of the blob
+    CopyPendingTimers(&game->lifetimes, (TimerEntry*) (writer.data + writer.offset));
+    writer.offset += header.timer_count * sizeof(TimerEntry);
+    Write(&writer, game->spawner.rules, header.spawn_rule_count * sizeof(SpawnRule));
+    Write(&writer, game->spawner.queue, header.spawn_event_count * sizeof(SpawnEvent));
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        Write(&writer, game->star_field.layers[l].x, header.star_counts[l] * sizeof(float));
+        Write(&writer, game->star_field.layers[l].y, header.star_counts[l] * sizeof(float));
+    }
+    const int particle_bytes = header.particle_count * sizeof(float);
+    Write(&writer, debris->x, particle_bytes);
+    Write(&writer, debris->y, particle_bytes);
+    Write(&writer, debris->vx, particle_bytes);
+    Write(&writer, debris->vy, particle_bytes);
+    Write(&writer, debris->life, particle_bytes);
+    Write(&writer, debris->inv_life, particle_bytes);
+    Write(&writer, debris->color, header.particle_count * sizeof(Color));
+}
+
+static inline bool IsSpriteTypeValid(int type) {
+    return type > -TEXTURE_COUNT && type < TEXTURE_COUNT;
+}
+
+// Fields the restore uses as array indexes: the state picks handlers, sprite
+// types pick textures, timer ids pick sprites and spawn events pick rules.
+// All are checked in the blob, which starts at the sprites, before the game
+// is touched.
+static bool AreSnapshotIndexesValid(const SnapshotHeader* header, const SnapshotCore* core, const unsigned char* data) {
+    if(core->state < 0 || core->state >= STATE_COUNT || !IsSpriteTypeValid(core->sun_sprite.type)) { return false; }
+    for(int i = 0; i < header->sprite_count; i++) {
+        Sprite sprite;
+        memcpy(&sprite, data, sizeof(Sprite));
+        data += sizeof(Sprite);
+        if(!IsSpriteTypeValid(sprite.type)) { return false; }
+    }
+    for(int i = 0; i < header->timer_count; i++) {
+        TimerEntry entry;
+        memcpy(&entry, data, sizeof(TimerEntry));
+        data += sizeof(TimerEntry);
+        if(entry.id < 0 || entry.id >= header->sprite_count) { return false; }
+    }
+    for(int i = 0; i < header->spawn_rule_count; i++) {
+        SpawnRule rule;
+        memcpy(&rule, data, sizeof(SpawnRule));
+        data += sizeof(SpawnRule);
+        if(rule.count < 0 || rule.count > SPAWN_MAX_BATCH) { return false; }
+    }
+    for(int i = 0; i < header->spawn_event_count; i++) {
+        SpawnEvent event;
+        memcpy(&event, data, sizeof(SpawnEvent));
+        data += sizeof(SpawnEvent);
+        if(event.rule_idx < 0 || event.rule_idx >= header->spawn_rule_count) { return false; }
+    }
+    return true;
+}
+
+bool RestoreGameSnapshot(Game* game, const GameSnapshot* snapshot) {
+    BlobReader reader = { snapshot->data, 0, snapshot->size };
+    SnapshotHeader header;
+    SnapshotCore core;
+    if(!Read(&reader, &header, sizeof(header)) || memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        TraceLog(LOG_WARNING, "Snapshot: not a game snapshot");
+        return false;
+    }
+    if(header.version != SNAPSHOT_VERSION || header.core_size != sizeof(SnapshotCore) ||
+       header.sprite_size != sizeof(Sprite) || header.timer_size != sizeof(TimerEntry)) {
+        TraceLog(LOG_WARNING, "Snapshot: version %u from another build, expected version %u", header.version, SNAPSHOT_VERSION);
+        return false;
+    }
+    if(header.sprite_count < 0 || header.timer_count < 0 || header.spawn_rule_count < 0 ||
+       header.spawn_event_count < 0 || header.particle_count < 0 || header.particle_count > PARTICLE_MAX_COUNT ||
+       header.size != (unsigned int) snapshot->size || GetSnapshotSize(&header) != (long long) header.size ||
+       !Read(&reader, &core, sizeof(core))) {
+        TraceLog(LOG_WARNING, "Snapshot: truncated or corrupt");
+        return false;
+    }
+    if(core.world_w != game->world_w || core.world_h != game->world_h) {
+        TraceLog(LOG_WARNING, "Snapshot: world is %dx%d, this game is %dx%d", core.world_w, core.world_h, game->world_w, game->world_h);
+        return false;
+    }
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        if(header.star_counts[l] != game->star_field.layers[l].padded_count) {
+            TraceLog(LOG_WARNING, "Snapshot: star count does not match this game");
+            return false;
+        }
+    }
+
+    const int timers_offset = reader.offset + header.sprite_count * (int) sizeof(Sprite);
+    if(!AreSnapshotIndexesValid(&header, &core, reader.data + reader.offset)) {
+        TraceLog(LOG_WARNING, "Snapshot: corrupt state, sprite, timer or spawn entry");
+        return false;
+    }
+
+    // The counts add up to the blob size, so every read below fits
+    bool is_read = true;
+    sb_clear(game->sprites);
+    sb_add(game->sprites, header.sprite_count);
+    is_read &= Read(&reader, game->sprites, header.sprite_count * sizeof(Sprite));
+    for(int i = 0; i < header.sprite_count; i++) { RelinkTexture(game, &game->sprites[i]); }
+
+    LoadPendingTimers(&game->lifetimes, core.lifetime_tick, (const TimerEntry*) (reader.data + timers_offset), header.timer_count);
+    reader.offset += header.timer_count * sizeof(TimerEntry);
+
+    sb_clear(game->spawner.rules);
+    sb_clear(game->spawner.queue);
+    sb_add(game->spawner.rules, header.spawn_rule_count);
+    sb_add(game->spawner.queue, header.spawn_event_count);
+    is_read &= Read(&reader, game->spawner.rules, header.spawn_rule_count * sizeof(SpawnRule));
+    is_read &= Read(&reader, game->spawner.queue, header.spawn_event_count * sizeof(SpawnEvent));
+
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        is_read &= Read(&reader, game->star_field.layers[l].x, header.star_counts[l] * sizeof(float));
+        is_read &= Read(&reader, game->star_field.layers[l].y, header.star_counts[l] * sizeof(float));
+    }
+
+    ParticleSystem* debris = &game->debris;
+    ReserveParticles(debris, header.particle_count);
+    const int particle_bytes = header.particle_count * sizeof(float);
+    is_read &= Read(&reader, debris->x, particle_bytes);
+    is_read &= Read(&reader, debris->y, particle_bytes);
+    is_read &= Read(&reader, debris->vx, particle_bytes);
+    is_read &= Read(&reader, debris->vy, particle_bytes);
+    is_read &= Read(&reader, debris->life, particle_bytes);
+    is_read &= Read(&reader, debris->inv_life, particle_bytes);
+    is_read &= Read(&reader, debris->color, header.particle_count * sizeof(Color));
+    debris->count = is_read ? header.particle_count : 0;
+    if(!is_read) {
+        TraceLog(LOG_WARNING, "Snapshot: ran short while restoring");
+        return false;
+    }
+
+    ApplySnapshotCore(game, &core);
+    ClearGameEvents(&game->events);
+    return true;
+}
+
+void FreeGameSnapshot(GameSnapshot* snapshot) {
+    free(snapshot->data);
+    *snapshot = GameSnapshot();
+}
+
+bool SaveGameSnapshot(const GameSnapshot* snapshot, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if(file == nullptr) {
+        TraceLog(LOG_WARNING, "Snapshot: could not create %s", filename);
+        return false;
+    }
+    bool is_written = fwrite(snapshot->data, 1, snapshot->size, file) == (size_t) snapshot->size;
+    fclose(file);
+    if(!is_written) { TraceLog(LOG_WARNING, "Snapshot: could not write %s", filename); }
+    return is_written;
+}
+
+bool LoadGameSnapshot(GameSnapshot* snapshot, const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if(file == nullptr) {
+        TraceLog(LOG_WARNING, "Snapshot: could not open %s", filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if(size <= 0) {
+        fclose(file);
+        TraceLog(LOG_WARNING, "Snapshot: %s is empty", filename);
+        return false;
+    }
+    if(snapshot->capacity < size) {
+        snapshot->data = (unsigned char*) realloc(snapshot->data, size);
+        snapshot->capacity = (int) size;
+    }
+    bool is_read = fread(snapshot->data, 1, size, file) == (size_t) size;
+    fclose(file);
+    snapshot->size = is_read ? (int) size : 0;
+    if(!is_read) { TraceLog(LOG_WARNING, "Snapshot: could not read %s", filename); }
+    return is_read;
+}
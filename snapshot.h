@@ -0,0 +1,77 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game.h"
+
+
+// Binary snapshot of everything the simulation needs to carry on: the
+// screen state, sprites, lifetime timers, spawn queue, random streams, the
+// sim clock, stars and debris. Views (text layers) and the per-step
+// buffers (collision grid, events) are not part of it.
+//
+// A snapshot is one contiguous blob: a fixed header and core block followed
+// by the variable arrays, each written with a single copy. Saving writes the
+// blob in one go and loading reads it back in one go. Restoring into a game
+// made with the same config continues exactly where the capture left off,
+// so a snapshot can restart a run, resume a soak run from disk, or be
+// restored into several games to fork them from the same point.
+//
+// Files carry a magic and a version, plus the sizes of the stored structs,
+// so a snapshot from another build or format is rejected instead of
+// misread.
+const unsigned int SNAPSHOT_VERSION = 1;
+
+// Scalar game state; pointers and textures are left out. Also used on its
+// own by the rewind buffer.
+struct SnapshotCore {
+    int state;
+    int frame_index;
+    int world_w;
+    int world_h;
+    Sprite sun_sprite;
+    Sprite earth_sprite;
+    RandomStream spawn_random;
+    RandomStream effects_random;
+    RandomStream star_random;
+    RandomStream particle_random;
+    Timeline timeline;
+    Vector2 earth_pos;
+    float earth_radius;
+    long long lifetime_tick;
+    unsigned int next_lifetime_serial;
+    int mouse_init_x;
+    int mouse_init_y;
+    int mouse_has_moved;
+    float mouse_target_x;
+    float mouse_target_y;
+    float title_fade_alpha;
+    double earth_revolve_count;
+    double max_earth_revolve_count;
+    int asteroids_destroyed;
+    int flares_fired;
+    int is_earth_killed_by_flare;
+    float end_zoom_earth_target_x;
+    float end_zoom_earth_target_y;
+    float end_fade_alpha;
+};
+
+struct GameSnapshot {
+    unsigned char* data;
+    int size;
+    int capacity;
+};
+
+// Reuses the snapshot's buffer when it is big enough. Debris is only for
+// show; leaving it out makes a much smaller snapshot.
+void CaptureGameSnapshot(const Game* game, GameSnapshot* snapshot, bool has_debris = true);
+bool RestoreGameSnapshot(Game* game, const GameSnapshot* snapshot);
+void FreeGameSnapshot(GameSnapshot* snapshot);
+
+// The core alone; applying it leaves sprites, timers and arrays untouched
+void CaptureSnapshotCore(const Game* game, SnapshotCore* core);
+void ApplySnapshotCore(Game* game, const SnapshotCore* core);
+
+bool SaveGameSnapshot(const GameSnapshot* snapshot, const char* filename);
+bool LoadGameSnapshot(GameSnapshot* snapshot, const char* filename);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,391 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "softraster.h"
+#include "stretchy_buffer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SOFTRASTER_SSE2
+#endif
+
+
+// 5x7 glyphs for ASCII 32..126, one byte per column, bit 0 at the top. Laid
+// out in a 10 pixel cell like raylib's default font, so font sizes and
+// spacing line up with DrawText.
+static const unsigned char FONT_GLYPHS[95][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 },
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },
+    { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 },
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+    { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 },
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+    { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 },
+    { 0x00, 0x56, 0x36, 0x00, 0x00 }, { 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, { 0x32, 0x49, 0x79, 0x41, 0x3E },
+    { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x01, 0x01 },
+    { 0x3E, 0x41, 0x41, 0x51, 0x32 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 },
+    { 0x7F, 0x02, 0x04, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 },
+    { 0x46, 0x49, 0x49, 0x49, 0x31 }, { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F }, { 0x63, 0x14, 0x08, 0x14, 0x63 },
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x00 },
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7F, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 },
+    { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 },
+    { 0x7F, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 }, { 0x38, 0x44, 0x44, 0x48, 0x7F },
+    { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x08, 0x7E, 0x09, 0x01, 0x02 }, { 0x08, 0x14, 0x54, 0x54, 0x3C },
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x44, 0x3D, 0x00 },
+    { 0x00, 0x7F, 0x10, 0x28, 0x44 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x18, 0x04, 0x78 },
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0x7C, 0x14, 0x14, 0x14, 0x08 },
+    { 0x08, 0x14, 0x14, 0x18, 0x7C }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 },
+    { 0x04, 0x3F, 0x44, 0x40, 0x20 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C },
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0C, 0x50, 0x50, 0x50, 0x3C },
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x7F, 0x00, 0x00 },
+    { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 },
+};
+static const int FONT_BASE_SIZE = 10;
+static const int FONT_GLYPH_W = 5;
+static const int FONT_GLYPH_H = 7;
+static const int FONT_GLYPH_TOP = 1;    // Rows above the glyph inside the cell
+
+static Color* frame_pixels = nullptr;   // Current target: the framebuffer or a layer texture
+static int frame_w = 0;
+static int frame_h = 0;
+static Color* screen_pixels = nullptr;
+static int screen_w = 0;
+static int screen_h = 0;
+static Image* soft_images = nullptr;    // Texture id is index + 1
+
+
+//
+// Blending. Colour matches glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+// with the texel modulated by the tint. Alpha is composited "over", so an
+// opaque framebuffer stays opaque and layer targets keep usable coverage.
+//
+
+static inline unsigned char Div255(int x) {
+    x += 128;
+    return (unsigned char) ((x + (x >> 8)) >> 8);
+}
+
+static inline Color Modulate(Color texel, Color tint) {
+    Color c = { Div255(texel.r * tint.r), Div255(texel.g * tint.g), Div255(texel.b * tint.b), Div255(texel.a * tint.a) };
+    return c;
+}
+
+static inline void BlendPixel(Color* dst, Color src) {
+    if(src.a == 0) { return; }
+    if(src.a == 255) {
+        *dst = src;
+        return;
+    }
+    const int a = src.a;
+    const int ia = 255 - a;
+    dst->r = Div255(src.r * a + dst->r * ia);
+    dst->g = Div255(src.g * a + dst->g * ia);
+    dst->b = Div255(src.b * a + dst->b * ia);
+    dst->a = Div255(a * 255 + dst->a * ia);
+}
+
+#ifdef SOFTRASTER_SSE2
+static inline __m128i Div255x8(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static inline __m128i BlendHalf(__m128i src, __m128i dst) {
+    // Two pixels as 16-bit lanes; broadcast each pixel's alpha over its lanes.
+    // The alpha lane itself is weighted by 255 instead, for "over" coverage.
+    const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i inv_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    __m128i src_weight = _mm_or_si128(_mm_andnot_si128(alpha_lanes, alpha), _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+    return Div255x8(_mm_add_epi16(_mm_mullo_epi16(src, src_weight), _mm_mullo_epi16(dst, inv_alpha)));
+}
+
+// Four texels, modulated by a tint given as 16-bit r,g,b,a,r,g,b,a lanes
+static inline __m128i Blend4(__m128i src, __m128i dst, __m128i tint16) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i src_lo = Div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), tint16));
+    __m128i src_hi = Div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), tint16));
+    __m128i out_lo = BlendHalf(src_lo, _mm_unpacklo_epi8(dst, zero));
+    __m128i out_hi = BlendHalf(src_hi, _mm_unpackhi_epi8(dst, zero));
+    return _mm_packus_epi16(out_lo, out_hi);
+}
+#endif
+
+static void BlendSpanSolid(Color* dst, int count, Color color) {
+    if(color.a == 0) { return; }
+    int i = 0;
+#ifdef SOFTRASTER_SSE2
+    const __m128i src = _mm_set1_epi32((int) (color.r | (color.g << 8) | (color.b << 16) | ((unsigned int) color.a << 24)));
+    const __m128i opaque = _mm_set1_epi16(255);
+    for(; i + 4 <= count; i += 4) {
+        __m128i* p = (__m128i*) (dst + i);
+        _mm_storeu_si128(p, color.a == 255 ? src : Blend4(src, _mm_loadu_si128(p), opaque));
+    }
+#endif
+    for(; i < count; i++) {
+        BlendPixel(&dst[i], color);
+    }
+}
+
+static void BlendRect(int x, int y, int w, int h, Color color) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > frame_w ? frame_w : x + w;
+    int y1 = y + h > frame_h ? frame_h : y + h;
+    if(x0 >= x1) { return; }
+    for(int py = y0; py < y1; py++) {
+        BlendSpanSolid(frame_pixels + (py * frame_w) + x0, x1 - x0, color);
+    }
+}
+
+
+void InitSoftRaster(int width, int height) {
+    screen_w = width;
+    screen_h = height;
+    screen_pixels = (Color*) malloc(sizeof(Color) * width * height);
+    SoftEndTarget();
+    SoftClear(BLACK);
+}
+
+void CloseSoftRaster() {
+    for(int i = 0; i < sb_count(soft_images); i++) {
+        if(soft_images[i].data != nullptr) { UnloadImage(soft_images[i]); }
+    }
+    sb_free(soft_images);
+    soft_images = nullptr;
+    free(screen_pixels);
+    screen_pixels = nullptr;
+    frame_pixels = nullptr;
+}
+
+Texture2D SoftLoadTexture(const char* filename) {
+    Texture2D tex = Texture2D();
+    Image img = LoadImage(filename);
+    if(img.data == nullptr) { return tex; }
+    ImageFormat(&img, UNCOMPRESSED_R8G8B8A8);
+    sb_push(soft_images, img);
+    tex.id = (unsigned int) sb_count(soft_images);
+    tex.width = img.width;
+    tex.height = img.height;
+    tex.mipmaps = 1;
+    tex.format = UNCOMPRESSED_R8G8B8A8;
+    return tex;
+}
+
+Texture2D SoftCreateTexture(int width, int height) {
+    Texture2D tex = Texture2D();
+    Image img = { calloc(width * height, sizeof(Color)), width, height, 1, UNCOMPRESSED_R8G8B8A8 };
+    sb_push(soft_images, img);
+    tex.id = (unsigned int) sb_count(soft_images);
+    tex.width = width;
+    tex.height = height;
+    tex.mipmaps = 1;
+    tex.format = UNCOMPRESSED_R8G8B8A8;
+    return tex;
+}
+
+void SoftBeginTarget(Texture2D texture) {
+    if(texture.id == 0 || (int) texture.id > sb_count(soft_images)) { return; }
+    Image* img = &soft_images[texture.id - 1];
+    if(img->data == nullptr) { return; }
+    frame_pixels = (Color*) img->data;
+    frame_w = img->width;
+    frame_h = img->height;
+    memset(frame_pixels, 0, sizeof(Color) * frame_w * frame_h);
+}
+
+void SoftEndTarget() {
+    frame_pixels = screen_pixels;
+    frame_w = screen_w;
+    frame_h = screen_h;
+}
+
+void SoftUnloadTexture(Texture2D texture) {
+    if(texture.id == 0 || (int) texture.id > sb_count(soft_images)) { return; }
+    Image* img = &soft_images[texture.id - 1];
+    if(img->data != nullptr) {
+        UnloadImage(*img);
+        img->data = nullptr;
+    }
+}
+
+void SoftClear(Color color) {
+    color.a = 255;
+    const int count = frame_w * frame_h;
+    for(int i = 0; i < count; i++) {
+        frame_pixels[i] = color;
+    }
+}
+
+void SoftDrawPixel(int x, int y, Color color) {
+    if(x < 0 || y < 0 || x >= frame_w || y >= frame_h) { return; }
+    BlendPixel(&frame_pixels[(y * frame_w) + x], color);
+}
+
+void SoftDrawLine(int start_x, int start_y, int end_x, int end_y, Color color) {
+    const int dx = end_x - start_x;
+    const int dy = end_y - start_y;
+    if(dy == 0) {
+        // Horizontal runs go through the span filler; the end pixel is left out like GL does
+        if(start_y < 0 || start_y >= frame_h || dx == 0) { return; }
+        int x0 = dx > 0 ? start_x : end_x + 1;
+        int x1 = dx > 0 ? end_x : start_x + 1;
+        if(x0 < 0) { x0 = 0; }
+        if(x1 > frame_w) { x1 = frame_w; }
+        if(x0 < x1) { BlendSpanSolid(frame_pixels + (start_y * frame_w) + x0, x1 - x0, color); }
+        return;
+    }
+    const int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    const float step_x = (float) dx / steps;
+    const float step_y = (float) dy / steps;
+    for(int i = 0; i < steps; i++) {
+        SoftDrawPixel((int) floorf(start_x + (step_x * i) + 0.5f), (int) floorf(start_y + (step_y * i) + 0.5f), color);
+    }
+}
+
+// Solid axis-aligned rectangle, blended and clipped to the framebuffer
+void SoftFillRect(int x, int y, int width, int height, Color color) {
+    BlendRect(x, y, width, height, color);
+}
+
+// Narrows [lo, hi) to the x values where 0 <= base + slope * x < limit
+static inline void ClipSpan(float base, float slope, float limit, float* lo, float* hi) {
+    if(fabsf(slope) < 1e-6f) {
+        if(base < 0.f || base >= limit) { *lo = 1.f; *hi = 0.f; }
+        return;
+    }
+    float a = -base / slope;
+    float b = (limit - base) / slope;
+    if(a > b) { float t = a; a = b; b = t; }
+    if(a > *lo) { *lo = a; }
+    if(b < *hi) { *hi = b; }
+}
+
+void SoftDrawTexturePro(Texture2D texture, Rectangle src_rect, Rectangle dest_rect, Vector2 origin, float rotation, Color tint) {
+    if(texture.id == 0 || (int) texture.id > sb_count(soft_images)) { return; }
+    const Image* img = &soft_images[texture.id - 1];
+    if(img->data == nullptr || dest_rect.width <= 0.f || dest_rect.height <= 0.f || tint.a == 0) { return; }
+    const unsigned int* texels = (const unsigned int*) img->data;
+    const int tex_w = img->width;
+    const int tex_h = img->height;
+
+    // Same transform as DrawTexturePro: rotate about dest position, then offset by origin
+    const float c = cosf(DEG2RAD * rotation);
+    const float s = sinf(DEG2RAD * rotation);
+    float min_y = 1e30f, max_y = -1e30f;
+    const float corner_x[4] = { 0.f, dest_rect.width, dest_rect.width, 0.f };
+    const float corner_y[4] = { 0.f, 0.f, dest_rect.height, dest_rect.height };
+    for(int i = 0; i < 4; i++) {
+        float y = dest_rect.y + (s * (corner_x[i] - origin.x)) + (c * (corner_y[i] - origin.y));
+        if(y < min_y) { min_y = y; }
+        if(y > max_y) { max_y = y; }
+    }
+    int y0 = (int) floorf(min_y);
+    int y1 = (int) ceilf(max_y);
+    if(y0 < 0) { y0 = 0; }
+    if(y1 > frame_h) { y1 = frame_h; }
+
+    const float scale_u = src_rect.width / dest_rect.width;
+    const float scale_v = src_rect.height / dest_rect.height;
+#ifdef SOFTRASTER_SSE2
+    const __m128i tint16 = _mm_set_epi16(tint.a, tint.b, tint.g, tint.r, tint.a, tint.b, tint.g, tint.r);
+    const __m128 lane = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+    const __m128 max_u = _mm_set1_ps((float) (tex_w - 1));
+    const __m128 max_v = _mm_set1_ps((float) (tex_h - 1));
+    const __m128 row_stride = _mm_set1_ps((float) tex_w);
+    const bool is_white_tint = tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255;
+#endif
+
+    for(int py = y0; py < y1; py++) {
+        // Quad-local coordinates of pixel centre px on this row: base + slope * px
+        const float cy = py + 0.5f - dest_rect.y;
+        const float cx = 0.5f - dest_rect.x;
+        const float base_x = (c * cx) + (s * cy) + origin.x;
+        const float base_y = (-s * cx) + (c * cy) + origin.y;
+        float lo = -1e30f, hi = 1e30f;
+        ClipSpan(base_x, c, dest_rect.width, &lo, &hi);
+        ClipSpan(base_y, -s, dest_rect.height, &lo, &hi);
+        if(lo >= hi) { continue; }
+        int x0 = lo < 0.f ? 0 : (int) ceilf(lo);
+        int x1 = hi > (float) frame_w ? frame_w : (int) ceilf(hi);
+        if(x0 >= x1) { continue; }
+
+        Color* dst = frame_pixels + (py * frame_w);
+        int px = x0;
+#ifdef SOFTRASTER_SSE2
+        // Texel addresses for four pixels at once; clamping in float keeps the
+        // truncation identical to the scalar path for in-range coordinates
+        const __m128 u_base = _mm_set1_ps(src_rect.x + (base_x * scale_u));
+        const __m128 v_base = _mm_set1_ps(src_rect.y + (base_y * scale_v));
+        const __m128 u_step = _mm_set1_ps(c * scale_u);
+        const __m128 v_step = _mm_set1_ps(-s * scale_v);
+        for(; px + 4 <= x1; px += 4) {
+            const __m128 x = _mm_add_ps(_mm_set1_ps((float) px), lane);
+            __m128 u = _mm_add_ps(u_base, _mm_mul_ps(x, u_step));
+            __m128 v = _mm_add_ps(v_base, _mm_mul_ps(x, v_step));
+            u = _mm_max_ps(_mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(u)), max_u), _mm_setzero_ps());
+            v = _mm_max_ps(_mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(v)), max_v), _mm_setzero_ps());
+            int idx[4];
+            _mm_storeu_si128((__m128i*) idx, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, row_stride), u)));
+            const unsigned int quad[4] = { texels[idx[0]], texels[idx[1]], texels[idx[2]], texels[idx[3]] };
+            if(((quad[0] | quad[1] | quad[2] | quad[3]) >> 24) == 0) { continue; }
+            __m128i* p = (__m128i*) (dst + px);
+            if(is_white_tint && ((quad[0] & quad[1] & quad[2] & quad[3]) >> 24) == 0xff) {
+                _mm_storeu_si128(p, _mm_loadu_si128((const __m128i*) quad));
+                continue;
+            }
+            _mm_storeu_si128(p, Blend4(_mm_loadu_si128((const __m128i*) quad), _mm_loadu_si128(p), tint16));
+        }
+#endif
+        for(; px < x1; px++) {
+            int u = (int) (src_rect.x + ((base_x + (c * px)) * scale_u));
+            int v = (int) (src_rect.y + ((base_y - (s * px)) * scale_v));
+            u = u < 0 ? 0 : (u >= tex_w ? tex_w - 1 : u);
+            v = v < 0 ? 0 : (v >= tex_h ? tex_h - 1 : v);
+            const Color* texel = (const Color*) &texels[(v * tex_w) + u];
+            BlendPixel(&dst[px], Modulate(*texel, tint));
+        }
+    }
+}
+
+void SoftDrawText(const char* text, int x, int y, int font_size, Color color) {
+    if(font_size < FONT_BASE_SIZE) { font_size = FONT_BASE_SIZE; }
+    const int spacing = font_size / FONT_BASE_SIZE;
+    const float scale = (float) font_size / FONT_BASE_SIZE;
+    float pen_x = (float) x;
+    float pen_y = (float) y;
+    for(const char* ch = text; *ch != '\0'; ch++) {
+        if(*ch == '\n') {
+            pen_x = (float) x;
+            pen_y += (FONT_BASE_SIZE + FONT_BASE_SIZE / 2) * scale;
+            continue;
+        }
+        int glyph = (unsigned char) *ch - 32;
+        if(glyph < 0 || glyph >= 95) { glyph = '?' - 32; }
+        for(int col = 0; col < FONT_GLYPH_W; col++) {
+            const unsigned char bits = FONT_GLYPHS[glyph][col];
+            if(bits == 0) { continue; }
+            const int gx0 = (int) (pen_x + (col * scale));
+            const int gx1 = (int) (pen_x + ((col + 1) * scale));
+            for(int row = 0; row < FONT_GLYPH_H; row++) {
+                if(!(bits & (1 << row))) { continue; }
+                const int gy0 = (int) (pen_y + ((row + FONT_GLYPH_TOP) * scale));
+                const int gy1 = (int) (pen_y + ((row + FONT_GLYPH_TOP + 1) * scale));
+                BlendRect(gx0, gy0, gx1 - gx0, gy1 - gy0, color);
+            }
+        }
+        pen_x += (FONT_GLYPH_W * scale) + spacing;
+    }
+}
+
+Image SoftGetFrameImage() {
+    Image img = { screen_pixels, screen_w, screen_h, 1, UNCOMPRESSED_R8G8B8A8 };
+    return img;
+}
@@ -0,0 +1,31 @@
+#ifndef SOFTRASTER_H
+#define SOFTRASTER_H
+
+#include "raylib.h"
+
+
+// CPU rasterizer behind the software gfx backend. Draws into one RGBA8
+// framebuffer with the same blending raylib uses (src alpha, one minus src
+// alpha). Textures are plain images in RAM, addressed by the id in the
+// returned Texture2D. Spans are blended four pixels at a time with SSE2.
+void InitSoftRaster(int width, int height);
+void CloseSoftRaster();
+
+Texture2D SoftLoadTexture(const char* filename);
+Texture2D SoftCreateTexture(int width, int height);
+void SoftUnloadTexture(Texture2D texture);
+
+// Redirects drawing into a texture, cleared to transparent, until SoftEndTarget
+void SoftBeginTarget(Texture2D texture);
+void SoftEndTarget();
+
+void SoftClear(Color color);
+void SoftDrawPixel(int x, int y, Color color);
+void SoftDrawLine(int start_x, int start_y, int end_x, int end_y, Color color);
+void SoftFillRect(int x, int y, int width, int height, Color color);
+void SoftDrawTexturePro(Texture2D texture, Rectangle src_rect, Rectangle dest_rect, Vector2 origin, float rotation, Color tint);
+void SoftDrawText(const char* text, int x, int y, int font_size, Color color);
+
+Image SoftGetFrameImage();
+
+#endif // SOFTRASTER_H
@@ -0,0 +1,77 @@
+#include <stdlib.h>
+#include "spatialgrid.h"
+
+
+static inline int CellCoord(float pos, float cell_size, int cells) {
+    int cell = (int) (pos / cell_size);
+    if(pos < 0.f || cell < 0) { return 0; }
+    return cell < cells ? cell : cells - 1;
+}
+
+void InitSpatialGrid(SpatialGrid* grid, float width, float height, float cell_size) {
+    grid->cell_size = cell_size;
+    grid->cols = (int) (width / cell_size) + 1;
+    grid->rows = (int) (height / cell_size) + 1;
+    grid->max_radius = 0.f;
+    grid->cell_heads = (int*) malloc(sizeof(int) * grid->cols * grid->rows);
+    grid->entry_capacity = 256;
+    grid->entry_ids = (int*) malloc(sizeof(int) * grid->entry_capacity);
+    grid->entry_next = (int*) malloc(sizeof(int) * grid->entry_capacity);
+    grid->result_capacity = 256;
+    grid->results = (int*) malloc(sizeof(int) * grid->result_capacity);
+    ClearSpatialGrid(grid);
+}
+
+void ClearSpatialGrid(SpatialGrid* grid) {
+    for(int i = 0; i < grid->cols * grid->rows; i++) {
+        grid->cell_heads[i] = -1;
+    }
+    grid->entry_count = 0;
+    grid->max_radius = 0.f;
+}
+
+void InsertSpatialGrid(SpatialGrid* grid, int id, float x, float y, float radius) {
+    if(grid->entry_count == grid->entry_capacity) {
+        grid->entry_capacity *= 2;
+        grid->entry_ids = (int*) realloc(grid->entry_ids, sizeof(int) * grid->entry_capacity);
+        grid->entry_next = (int*) realloc(grid->entry_next, sizeof(int) * grid->entry_capacity);
+    }
+    const int cell = CellCoord(y, grid->cell_size, grid->rows) * grid->cols + CellCoord(x, grid->cell_size, grid->cols);
+    const int entry = grid->entry_count++;
+    grid->entry_ids[entry] = id;
+    grid->entry_next[entry] = grid->cell_heads[cell];
+    grid->cell_heads[cell] = entry;
+    if(radius > grid->max_radius) { grid->max_radius = radius; }
+}
+
+const int* QuerySpatialGrid(SpatialGrid* grid, float x, float y, float reach, int* count) {
+    const int min_col = CellCoord(x - reach, grid->cell_size, grid->cols);
+    const int max_col = CellCoord(x + reach, grid->cell_size, grid->cols);
+    const int min_row = CellCoord(y - reach, grid->cell_size, grid->rows);
+    const int max_row = CellCoord(y + reach, grid->cell_size, grid->rows);
+    int found = 0;
+    for(int row = min_row; row <= max_row; row++) {
+        for(int col = min_col; col <= max_col; col++) {
+            for(int entry = grid->cell_heads[row * grid->cols + col]; entry >= 0; entry = grid->entry_next[entry]) {
+                if(found == grid->result_capacity) {
+                    grid->result_capacity *= 2;
+                    grid->results = (int*) realloc(grid->results, sizeof(int) * grid->result_capacity);
+                }
+                grid->results[found++] = grid->entry_ids[entry];
+            }
+        }
+    }
+    *count = found;
+    return grid->results;
+}
+
+void FreeSpatialGrid(SpatialGrid* grid) {
+    free(grid->cell_heads);
+    free(grid->entry_ids);
+    free(grid->entry_next);
+    free(grid->results);
+    grid->cell_heads = nullptr;
+    grid->entry_ids = nullptr;
+    grid->entry_next = nullptr;
+    grid->results = nullptr;
+}
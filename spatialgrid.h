@@ -0,0 +1,34 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+
+// Uniform grid over the playfield for broad-phase collision queries. Items
+// are bucketed by centre point, and a query returns every item whose cell
+// lies within the search box. Items can be added between queries, so
+// sprites spawned mid-pass (explosions) are seen by later checks. Items
+// outside the field land in the border cells. Removed items are not taken
+// out and an id may be inserted again, so callers skip dead or duplicate
+// entries; the grid is cleared and refilled every frame.
+struct SpatialGrid {
+    float cell_size;
+    int cols;
+    int rows;
+    float max_radius;           // Largest radius inserted since the last clear
+    int* cell_heads;            // First entry per cell, -1 when empty
+    int* entry_ids;
+    int* entry_next;            // Next entry in the same cell
+    int entry_count;
+    int entry_capacity;
+    int* results;
+    int result_capacity;
+};
+
+void InitSpatialGrid(SpatialGrid* grid, float width, float height, float cell_size);
+void ClearSpatialGrid(SpatialGrid* grid);
+void InsertSpatialGrid(SpatialGrid* grid, int id, float x, float y, float radius);
+// Returns the ids of items in cells touching the box around (x, y); the
+// pointer is valid until the next query
+const int* QuerySpatialGrid(SpatialGrid* grid, float x, float y, float reach, int* count);
+void FreeSpatialGrid(SpatialGrid* grid);
+
+#endif // SPATIALGRID_H
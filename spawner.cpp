@@ -0,0 +1,141 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "spawner.h"
+#include "orbit.h"
+#include "raylib.h"
+#include "sbutil.h"
+#include "stretchy_buffer.h"
+
+
+static const SpawnRule DEFAULT_RULES[] = {
+    { .kind = SPAWN_KIND_AMBIENT, .first_delay = 0.f, .from_year = 0.f, .period_years = 1.f, .year_offset = 7.f, .count = 1 },
+    { .kind = SPAWN_KIND_TARGETED, .first_delay = 0.5f, .from_year = 0.f, .period_years = 1.f, .year_offset = 4.f, .count = 1 }
+};
+
+static const double MIN_SPAWN_INTERVAL = 0.001;   // Seconds, so a bad rule can't stall a frame
+
+static inline bool IsEarlier(const SpawnEvent& a, const SpawnEvent& b) {
+    // Ties go to the earlier rule in the table
+    return a.due < b.due || (a.due == b.due && a.rule_idx < b.rule_idx);
+}
+
+static void PushEvent(SpawnScheduler* scheduler, SpawnEvent event) {
+    sb_push(scheduler->queue, event);
+    int i = sb_count(scheduler->queue) - 1;
+    while(i > 0) {
+        int parent = (i - 1) / 2;
+        if(!IsEarlier(scheduler->queue[i], scheduler->queue[parent])) { break; }
+        SpawnEvent tmp = scheduler->queue[i];
+        scheduler->queue[i] = scheduler->queue[parent];
+        scheduler->queue[parent] = tmp;
+        i = parent;
+    }
+}
+
+static void PopEvent(SpawnScheduler* scheduler) {
+    SpawnEvent* heap = scheduler->queue;
+    int count = sb_count(heap) - 1;
+    heap[0] = heap[count];
+    sb_setcount(scheduler->queue, count);
+    int i = 0;
+    while(true) {
+        int left = 2 * i + 1;
+        int right = left + 1;
+        int smallest = i;
+        if(left < count && IsEarlier(heap[left], heap[smallest])) { smallest = left; }
+        if(right < count && IsEarlier(heap[right], heap[smallest])) { smallest = right; }
+        if(smallest == i) { break; }
+        SpawnEvent tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void SetDefaultRules(SpawnScheduler* scheduler) {
+    sb_clear(scheduler->rules);
+    for(unsigned int i = 0; i < sizeof(DEFAULT_RULES) / sizeof(DEFAULT_RULES[0]); i++) {
+        sb_push(scheduler->rules, DEFAULT_RULES[i]);
+    }
+}
+
+void InitSpawnScheduler(SpawnScheduler* scheduler) {
+    scheduler->rules = nullptr;
+    scheduler->queue = nullptr;
+    SetDefaultRules(scheduler);
+}
+
+bool LoadSpawnRules(SpawnScheduler* scheduler, const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if(file == nullptr) {
+        TraceLog(LOG_WARNING, "Could not open spawn table %s, using the built-in rules", filename);
+        return false;
+    }
+
+    // One rule per line: kind first_delay from_year period_years year_offset count
+    SpawnRule* rules = nullptr;
+    char line[256];
+    int line_number = 0;
+    while(fgets(line, sizeof(line), file) != nullptr) {
+        line_number++;
+        char kind[32];
+        SpawnRule rule = SpawnRule();
+        int fields = sscanf(line, " %31s %f %f %f %f %d", kind, &rule.first_delay, &rule.from_year,
+                            &rule.period_years, &rule.year_offset, &rule.count);
+        if(fields <= 0 || kind[0] == '#') { continue; }
+        if(strcmp(kind, "ambient") == 0) {
+            rule.kind = SPAWN_KIND_AMBIENT;
+        } else if(strcmp(kind, "targeted") == 0) {
+            rule.kind = SPAWN_KIND_TARGETED;
+        } else {
+            fields = 0;
+        }
+        if(fields != 6 || rule.period_years <= 0.f || rule.count < 1) {
+            TraceLog(LOG_WARNING, "Spawn table %s: skipping bad rule on line %d", filename, line_number);
+            continue;
+        }
+        if(rule.count > SPAWN_MAX_BATCH) { rule.count = SPAWN_MAX_BATCH; }
+        sb_push(rules, rule);
+    }
+    fclose(file);
+
+    if(sb_count(rules) == 0) {
+        TraceLog(LOG_WARNING, "Spawn table %s has no rules, using the built-in rules", filename);
+        sb_free(rules);
+        return false;
+    }
+    sb_free(scheduler->rules);
+    scheduler->rules = rules;
+    TraceLog(LOG_INFO, "Loaded %d spawn rules from %s", sb_count(rules), filename);
+    return true;
+}
+
+void FreeSpawnScheduler(SpawnScheduler* scheduler) {
+    sb_free(scheduler->rules);
+    sb_free(scheduler->queue);
+    scheduler->rules = nullptr;
+    scheduler->queue = nullptr;
+}
+
+void ResetSpawnScheduler(SpawnScheduler* scheduler, double now) {
+    sb_clear(scheduler->queue);
+    for(int i = 0; i < sb_count(scheduler->rules); i++) {
+        const SpawnRule* rule = &scheduler->rules[i];
+        PushEvent(scheduler, { .due = now + rule->from_year * ORBIT_YEAR_SECONDS + rule->first_delay, .rule_idx = i });
+    }
+}
+
+bool PopDueSpawn(SpawnScheduler* scheduler, double now, SpawnEvent* event) {
+    if(sb_count(scheduler->queue) == 0 || scheduler->queue[0].due > now) { return false; }
+    *event = scheduler->queue[0];
+    PopEvent(scheduler);
+    return true;
+}
+
+void ScheduleNextSpawn(SpawnScheduler* scheduler, int rule_idx, double now, double years) {
+    const SpawnRule* rule = &scheduler->rules[rule_idx];
+    double interval = rule->period_years * ORBIT_YEAR_SECONDS / (floor(years) + rule->year_offset);
+    if(!(interval >= MIN_SPAWN_INTERVAL)) { interval = MIN_SPAWN_INTERVAL; }
+    PushEvent(scheduler, { .due = now + interval, .rule_idx = rule_idx });
+}
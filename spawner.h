@@ -0,0 +1,47 @@
+#ifndef SPAWNER_H
+#define SPAWNER_H
+
+
+// Asteroid spawning driven by a table of rules and a time-ordered queue.
+// Each rule fires a batch of spawns, then schedules its next batch after an
+// interval that shrinks as the years go by:
+//
+//     interval = period_years * ORBIT_YEAR_SECONDS / (floor(years) + year_offset)
+//
+// Pending events sit in a binary min-heap keyed on sim time, so each frame
+// only looks at the head of the queue. Rules come from a text file; the
+// built-in defaults match the original ambient and targeted asteroid timers.
+const int SPAWN_KIND_AMBIENT = 0;
+const int SPAWN_KIND_TARGETED = 1;
+const int SPAWN_MAX_BATCH = 256;
+
+struct SpawnRule {
+    int kind;
+    float first_delay;          // Seconds after from_year before the first batch
+    float from_year;            // Years into the game before the rule starts
+    float period_years;
+    float year_offset;
+    int count;                  // Spawns per batch
+};
+
+struct SpawnEvent {
+    double due;                 // Sim time
+    int rule_idx;
+};
+
+struct SpawnScheduler {
+    SpawnRule* rules;           // stretchy_buffer
+    SpawnEvent* queue;          // stretchy_buffer, kept as a binary min-heap
+};
+
+void InitSpawnScheduler(SpawnScheduler* scheduler);
+// Replaces the rules from a file; keeps the defaults if it can't be read
+bool LoadSpawnRules(SpawnScheduler* scheduler, const char* filename);
+void FreeSpawnScheduler(SpawnScheduler* scheduler);
+
+// Empties the queue and schedules every rule's first batch from now
+void ResetSpawnScheduler(SpawnScheduler* scheduler, double now);
+bool PopDueSpawn(SpawnScheduler* scheduler, double now, SpawnEvent* event);
+void ScheduleNextSpawn(SpawnScheduler* scheduler, int rule_idx, double now, double years);
+
+#endif // SPAWNER_H
@@ -0,0 +1,87 @@
+#include <math.h>
+#include <stdlib.h>
+#include "starfield.h"
+#include "gfx.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define STARFIELD_SSE2
+#endif
+
+
+// Speeds and lengths match the original 0.5, 1 and 1.5 pixel per frame stars
+static const float LAYER_SPEEDS[STARFIELD_LAYER_COUNT] = { 0.5f, 1.f, 1.5f };
+static const int LAYER_LENGTHS[STARFIELD_LAYER_COUNT] = { 1, 1, 3 };
+
+static inline void RespawnStar(StarField* field, StarLayer* layer, int i) {
+    layer->x[i] = field->width;
+    layer->y[i] = (float) RandomInt(&field->rng, 0, (int) field->height - 1);
+}
+
+void InitStarField(StarField* field, int count, float width, float height, unsigned int seed) {
+    field->width = width;
+    field->height = height;
+    SeedRandomStream(&field->rng, seed, RANDOM_STREAM_STARS);
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        StarLayer* layer = &field->layers[l];
+        layer->count = count / STARFIELD_LAYER_COUNT + (l < count % STARFIELD_LAYER_COUNT ? 1 : 0);
+        layer->padded_count = (layer->count + 3) & ~3;
+        layer->speed = LAYER_SPEEDS[l];
+        layer->length = LAYER_LENGTHS[l];
+        layer->x = (float*) malloc(sizeof(float) * (layer->padded_count > 0 ? layer->padded_count : 1));
+        layer->y = (float*) malloc(sizeof(float) * (layer->padded_count > 0 ? layer->padded_count : 1));
+        // Whole pixel positions, as the stars always had
+        RandomFloats(&field->rng, layer->x, layer->padded_count);
+        RandomFloats(&field->rng, layer->y, layer->padded_count);
+        for(int i = 0; i < layer->padded_count; i++) {
+            layer->x[i] = floorf(layer->x[i] * width);
+            layer->y[i] = floorf(layer->y[i] * height);
+        }
+    }
+}
+
+void UpdateStarField(StarField* field) {
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        StarLayer* layer = &field->layers[l];
+#ifdef STARFIELD_SSE2
+        const __m128 speed = _mm_set1_ps(layer->speed);
+        const __m128 zero = _mm_setzero_ps();
+        for(int i = 0; i < layer->padded_count; i += 4) {
+            __m128 x = _mm_sub_ps(_mm_loadu_ps(layer->x + i), speed);
+            _mm_storeu_ps(layer->x + i, x);
+            int wrapped = _mm_movemask_ps(_mm_cmplt_ps(x, zero));
+            if(wrapped == 0) { continue; }
+            for(int lane = 0; lane < 4; lane++) {
+                if(wrapped & (1 << lane)) { RespawnStar(field, layer, i + lane); }
+            }
+        }
+#else
+        for(int i = 0; i < layer->padded_count; i++) {
+            layer->x[i] -= layer->speed;
+        }
+        for(int i = 0; i < layer->padded_count; i++) {
+            if(layer->x[i] < 0.f) { RespawnStar(field, layer, i); }
+        }
+#endif
+    }
+}
+
+void DrawStarField(const StarField* field, Color color, float density) {
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        const StarLayer* layer = &field->layers[l];
+        // Same shapes as DrawPixel and DrawLine: a one pixel diagonal, or a horizontal dash
+        const float dx = (float) layer->length;
+        const float dy = layer->length == 1 ? 1.f : 0.f;
+        const int count = density < 1.f ? (int) (layer->count * density) : layer->count;
+        GfxLineBatch(layer->x, layer->y, count, dx, dy, color);
+    }
+}
+
+void FreeStarField(StarField* field) {
+    for(int l = 0; l < STARFIELD_LAYER_COUNT; l++) {
+        free(field->layers[l].x);
+        free(field->layers[l].y);
+        field->layers[l].x = nullptr;
+        field->layers[l].y = nullptr;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef STARFIELD_H
+#define STARFIELD_H
+
+#include "raylib.h"
+#include "random.h"
+
+
+// Background star field, split into parallax layers that each scroll left at
+// a fixed speed. Positions are kept as separate x and y arrays per layer so
+// the scroll-and-wrap runs four stars at a time, and each layer is drawn as
+// one batch of line primitives.
+const int STARFIELD_LAYER_COUNT = 3;
+
+struct StarLayer {
+    int count;
+    int padded_count;           // count rounded up to a multiple of 4
+    float speed;                // Pixels per frame
+    int length;                 // 1 draws a single pixel
+    float* x;
+    float* y;
+};
+
+struct StarField {
+    float width;
+    float height;
+    RandomStream rng;
+    StarLayer layers[STARFIELD_LAYER_COUNT];
+};
+
+void InitStarField(StarField* field, int count, float width, float height, unsigned int seed);
+void UpdateStarField(StarField* field);
+// density below 1 draws only that share of each layer; the stars are in
+// random order, so any prefix is an even spread
+void DrawStarField(const StarField* field, Color color, float density = 1.f);
+void FreeStarField(StarField* field);
+
+#endif // STARFIELD_H
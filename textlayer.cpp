@@ -0,0 +1,63 @@
+#include <math.h>
+#include <stdio.h>
+#include "textlayer.h"
+
+
+static unsigned int HashBytes(unsigned int hash, const void* data, int size) {
+    // FNV-1a
+    const unsigned char* bytes = (const unsigned char*) data;
+    for(int i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static unsigned int HashLines(const TextLayerLine* lines, int line_count) {
+    unsigned int hash = 2166136261u;
+    for(int i = 0; i < line_count; i++) {
+        for(const char* ch = lines[i].text; *ch != '\0'; ch++) {
+            hash = HashBytes(hash, ch, 1);
+        }
+        const int layout[3] = { lines[i].x, lines[i].y, lines[i].font_size };
+        hash = HashBytes(hash, layout, sizeof(layout));
+        hash = HashBytes(hash, &lines[i].color, sizeof(Color));
+    }
+    return hash;
+}
+
+void InitTextLayer(TextLayer* text_layer, int width, int height) {
+    text_layer->layer = GfxLoadLayer(width, height);
+    text_layer->built_hash = 0;
+    text_layer->is_built = false;
+}
+
+void DrawTextLayer(TextLayer* text_layer, const TextLayerLine* lines, int line_count, unsigned char alpha) {
+    const unsigned int hash = HashLines(lines, line_count);
+    if(!text_layer->is_built || hash != text_layer->built_hash) {
+        GfxBeginLayer(text_layer->layer);
+        for(int i = 0; i < line_count; i++) {
+            GfxText(lines[i].text, lines[i].x, lines[i].y, lines[i].font_size, lines[i].color);
+        }
+        GfxEndLayer();
+        text_layer->built_hash = hash;
+        text_layer->is_built = true;
+    }
+    GfxDrawLayer(text_layer->layer, 0, 0, { 255, 255, 255, alpha });
+}
+
+void UnloadTextLayer(TextLayer* text_layer) {
+    GfxUnloadLayer(text_layer->layer);
+    text_layer->is_built = false;
+}
+
+const char* CachedTextFormat(CachedText* cache, const char* format, double value, double resolution) {
+    const long long key = llround(value / resolution);
+    if(!cache->is_set || key != cache->shown_key || format != cache->format) {
+        snprintf(cache->text, sizeof(cache->text), format, value);
+        cache->format = format;
+        cache->shown_key = key;
+        cache->is_set = true;
+    }
+    return cache->text;
+}
@@ -0,0 +1,39 @@
+#ifndef TEXTLAYER_H
+#define TEXTLAYER_H
+
+#include "gfx.h"
+
+
+// Static screen text rendered once into an offscreen layer and drawn as one
+// quad. The layer is rebuilt only when its lines change; fades are applied
+// as a tint on the quad rather than by redrawing every line.
+struct TextLayerLine {
+    const char* text;
+    int x;
+    int y;
+    int font_size;
+    Color color;
+};
+
+struct TextLayer {
+    GfxLayer layer;
+    unsigned int built_hash;
+    bool is_built;
+};
+
+void InitTextLayer(TextLayer* text_layer, int width, int height);
+void DrawTextLayer(TextLayer* text_layer, const TextLayerLine* lines, int line_count, unsigned char alpha);
+void UnloadTextLayer(TextLayer* text_layer);
+
+// Formatted text for a changing number, reformatted only when the value as
+// displayed (rounded to resolution) changes
+struct CachedText {
+    char text[128];
+    const char* format;
+    long long shown_key;
+    bool is_set;
+};
+
+const char* CachedTextFormat(CachedText* cache, const char* format, double value, double resolution);
+
+#endif // TEXTLAYER_H
@@ -0,0 +1,133 @@
+#include <math.h>
+#include "timerwheel.h"
+#include "raylib.h"
+#include "sbutil.h"
+#include "stretchy_buffer.h"
+
+
+static const int SLOT_MASK = TIMERWHEEL_SLOTS - 1;
+static const long long MAX_DELTA = (1LL << (TIMERWHEEL_SLOT_BITS * TIMERWHEEL_LEVELS)) - 1;
+
+static void PlaceTimer(TimerWheel* wheel, TimerEntry entry) {
+    long long delta = entry.due_tick - wheel->current_tick;
+    // Timers past the top level wait in its furthest slot and are placed
+    // again when it cascades
+    long long slot_tick = delta > MAX_DELTA ? wheel->current_tick + MAX_DELTA : entry.due_tick;
+    if(delta > MAX_DELTA) { delta = MAX_DELTA; }
+    int level = 0;
+    while(level < TIMERWHEEL_LEVELS - 1 && delta >= (1LL << (TIMERWHEEL_SLOT_BITS * (level + 1)))) { level++; }
+    int slot = (int) ((slot_tick >> (TIMERWHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    sb_push(wheel->slots[level][slot], entry);
+}
+
+// Moves the slot of this level that the current tick falls in down to the
+// levels below
+static void CascadeLevel(TimerWheel* wheel, int level) {
+    int slot = (int) ((wheel->current_tick >> (TIMERWHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    TimerEntry* entries = wheel->slots[level][slot];
+    int count = sb_count(entries);
+    if(count == 0) { return; }
+    // Detach the slot first: an entry may land back in it
+    wheel->slots[level][slot] = nullptr;
+    for(int i = 0; i < count; i++) {
+        PlaceTimer(wheel, entries[i]);
+    }
+    wheel->stats.cascaded += count;
+    sb_free(entries);
+}
+
+void InitTimerWheel(TimerWheel* wheel, double tick_seconds, double now) {
+    *wheel = TimerWheel();
+    wheel->tick_seconds = tick_seconds;
+    wheel->current_tick = (long long) floor(now / tick_seconds);
+}
+
+void FreeTimerWheel(TimerWheel* wheel) {
+    for(int level = 0; level < TIMERWHEEL_LEVELS; level++) {
+        for(int slot = 0; slot < TIMERWHEEL_SLOTS; slot++) {
+            sb_free(wheel->slots[level][slot]);
+            wheel->slots[level][slot] = nullptr;
+        }
+    }
+    sb_free(wheel->due);
+    wheel->due = nullptr;
+    wheel->pending = 0;
+}
+
+void ClearTimerWheel(TimerWheel* wheel, double now) {
+    for(int level = 0; level < TIMERWHEEL_LEVELS; level++) {
+        for(int slot = 0; slot < TIMERWHEEL_SLOTS; slot++) {
+            sb_clear(wheel->slots[level][slot]);
+        }
+    }
+    sb_clear(wheel->due);
+    wheel->pending = 0;
+    wheel->current_tick = (long long) floor(now / wheel->tick_seconds);
+}
+
+void ScheduleTimer(TimerWheel* wheel, double due_time, int id, unsigned int serial) {
+    // Round up, so a timer never fires before its due time
+    long long due_tick = (long long) ceil(due_time / wheel->tick_seconds);
+    if(due_tick <= wheel->current_tick) { due_tick = wheel->current_tick + 1; }
+    PlaceTimer(wheel, { .due_tick = due_tick, .id = id, .serial = serial });
+    wheel->pending++;
+    wheel->stats.scheduled++;
+}
+
+int AdvanceTimerWheel(TimerWheel* wheel, double now, const TimerEntry** expired) {
+    sb_clear(wheel->due);
+    const long long target_tick = (long long) floor(now / wheel->tick_seconds);
+    while(wheel->current_tick < target_tick) {
+        if(wheel->pending == 0) {
+            wheel->current_tick = target_tick;
+            break;
+        }
+        wheel->current_tick++;
+        // Each time a level wraps back to slot 0, refill it from the level above
+        for(int level = 1; level < TIMERWHEEL_LEVELS; level++) {
+            if((wheel->current_tick & ((1LL << (TIMERWHEEL_SLOT_BITS * level)) - 1)) != 0) { break; }
+            CascadeLevel(wheel, level);
+        }
+        TimerEntry** slot = &wheel->slots[0][wheel->current_tick & SLOT_MASK];
+        int count = sb_count(*slot);
+        if(count == 0) { continue; }
+        TimerEntry* out = sb_add(wheel->due, count);
+        for(int i = 0; i < count; i++) { out[i] = (*slot)[i]; }
+        sb_clear(*slot);
+        wheel->pending -= count;
+    }
+
+    int count = sb_count(wheel->due);
+    wheel->stats.expired += count;
+    if(count > wheel->stats.max_expired) { wheel->stats.max_expired = count; }
+    *expired = wheel->due;
+    return count;
+}
+
+int CopyPendingTimers(const TimerWheel* wheel, TimerEntry* out) {
+    int count = 0;
+    for(int level = 0; level < TIMERWHEEL_LEVELS; level++) {
+        for(int slot = 0; slot < TIMERWHEEL_SLOTS; slot++) {
+            const TimerEntry* entries = wheel->slots[level][slot];
+            for(int i = 0; i < sb_count(entries); i++) { out[count++] = entries[i]; }
+        }
+    }
+    return count;
+}
+
+void LoadPendingTimers(TimerWheel* wheel, long long current_tick, const TimerEntry* entries, int count) {
+    ClearTimerWheel(wheel, 0.);
+    wheel->current_tick = current_tick;
+    for(int i = 0; i < count; i++) {
+        TimerEntry entry = entries[i];
+        if(entry.due_tick <= current_tick) { entry.due_tick = current_tick + 1; }
+        PlaceTimer(wheel, entry);
+    }
+    wheel->pending = count;
+}
+
+void LogTimerWheelStats(const TimerWheel* wheel, const char* name) {
+    const TimerWheelStats* stats = &wheel->stats;
+    TraceLog(LOG_INFO, "Timers (%s): %lld scheduled, %lld expired (at most %d in one frame), %lld cascaded, %d pending",
+             name, stats->scheduled, stats->expired, stats->max_expired, stats->cascaded, wheel->pending);
+}
@@ -0,0 +1,60 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+
+// Hierarchical timer wheel for entity lifetimes. Time is cut into ticks,
+// and each level holds TIMERWHEEL_SLOTS slots, each slot covering one tick
+// of the level below times TIMERWHEEL_SLOTS. A timer sits in the lowest
+// level that can hold its due tick; when a level wraps, the next slot of
+// the level above is cascaded down. Advancing the wheel only touches the
+// slots that come due, so the cost per frame follows the number of timers
+// that expire, not the number pending.
+//
+// Timers carry an id and a serial chosen by the caller. There is no
+// cancel: callers keep the serial of the live timer on the entity and
+// ignore expiries whose serial no longer matches.
+const int TIMERWHEEL_LEVELS = 4;
+const int TIMERWHEEL_SLOT_BITS = 6;
+const int TIMERWHEEL_SLOTS = 1 << TIMERWHEEL_SLOT_BITS;
+
+struct TimerEntry {
+    long long due_tick;
+    int id;
+    unsigned int serial;
+};
+
+struct TimerWheelStats {
+    long long scheduled;
+    long long expired;
+    long long cascaded;         // Moves down a level
+    int max_expired;            // Most timers due in one advance
+};
+
+struct TimerWheel {
+    double tick_seconds;
+    long long current_tick;     // Every tick up to here has been processed
+    int pending;
+    TimerEntry* slots[TIMERWHEEL_LEVELS][TIMERWHEEL_SLOTS];    // stretchy_buffers
+    TimerEntry* due;            // stretchy_buffer, refilled by each advance
+    TimerWheelStats stats;
+};
+
+void InitTimerWheel(TimerWheel* wheel, double tick_seconds, double now);
+void FreeTimerWheel(TimerWheel* wheel);
+// Drops every pending timer and restarts the wheel at now
+void ClearTimerWheel(TimerWheel* wheel, double now);
+
+// Fires on the first advance at or after due_time, never before it
+void ScheduleTimer(TimerWheel* wheel, double due_time, int id, unsigned int serial);
+// Returns the timers that came due up to now, in no particular order; the
+// pointer is valid until the next call
+int AdvanceTimerWheel(TimerWheel* wheel, double now, const TimerEntry** expired);
+
+// For snapshots: out must hold wheel->pending entries. Loading clears the
+// wheel, moves it to current_tick and places the given timers again.
+int CopyPendingTimers(const TimerWheel* wheel, TimerEntry* out);
+void LoadPendingTimers(TimerWheel* wheel, long long current_tick, const TimerEntry* entries, int count);
+
+void LogTimerWheelStats(const TimerWheel* wheel, const char* name);
+
+#endif // TIMERWHEEL_H
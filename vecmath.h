@@ -0,0 +1,86 @@
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <math.h>
+#include "raylib.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define VECMATH_SSE2
+#endif
+
+
+// Small 2D vector helpers on raylib's Vector2. Directions are unit vectors
+// rather than angles, so aiming and spawning cost a few multiplies and one
+// reciprocal square root instead of an atan2 and a cos/sin pair. Angles
+// passed in are in radians.
+
+static inline Vector2 Vec2(float x, float y) {
+    return (Vector2) { x, y };
+}
+
+static inline Vector2 Vec2Add(Vector2 a, Vector2 b) {
+    return (Vector2) { a.x + b.x, a.y + b.y };
+}
+
+static inline Vector2 Vec2Sub(Vector2 a, Vector2 b) {
+    return (Vector2) { a.x - b.x, a.y - b.y };
+}
+
+static inline Vector2 Vec2Scale(Vector2 v, float s) {
+    return (Vector2) { v.x * s, v.y * s };
+}
+
+static inline float Vec2Dot(Vector2 a, Vector2 b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+static inline float Vec2LengthSqr(Vector2 v) {
+    return v.x * v.x + v.y * v.y;
+}
+
+static inline float ReciprocalSqrt(float x) {
+#ifdef VECMATH_SSE2
+    // Hardware estimate plus one Newton step, good to about 22 bits
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    return y * (1.5f - 0.5f * x * y * y);
+#else
+    return 1.f / sqrtf(x);
+#endif
+}
+
+// Zero length vectors come back as zero
+static inline Vector2 Vec2Normalize(Vector2 v) {
+    float length_sqr = Vec2LengthSqr(v);
+    if(length_sqr <= 0.f) { return (Vector2) { 0.f, 0.f }; }
+    return Vec2Scale(v, ReciprocalSqrt(length_sqr));
+}
+
+// Unit vector pointing from one point to another. Coincident points give
+// +x, the same answer atan2f(0, 0) did.
+static inline Vector2 Vec2Direction(Vector2 from, Vector2 to) {
+    Vector2 delta = Vec2Sub(to, from);
+    if(Vec2LengthSqr(delta) <= 0.f) { return (Vector2) { 1.f, 0.f }; }
+    return Vec2Normalize(delta);
+}
+
+static inline Vector2 Vec2FromAngle(float radians) {
+    return (Vector2) { cosf(radians), sinf(radians) };
+}
+
+// Rotate by a unit vector (cos, sin), so repeated rotations by the same
+// angle need no trig at all
+static inline Vector2 Vec2RotateBy(Vector2 v, Vector2 rotor) {
+    return (Vector2) { v.x * rotor.x - v.y * rotor.y, v.x * rotor.y + v.y * rotor.x };
+}
+
+static inline Vector2 Vec2Rotate(Vector2 v, float radians) {
+    return Vec2RotateBy(v, Vec2FromAngle(radians));
+}
+
+// Sprite rotation in degrees for a direction, only needed for drawing
+static inline float Vec2AngleDegrees(Vector2 v) {
+    return RAD2DEG * atan2f(v.y, v.x);
+}
+
+#endif // VECMATH_H